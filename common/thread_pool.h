@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/* fork-join pool, every worker owns a deque and steals from the others when
+ * its own deque runs dry. tasks submitted from a worker stay on that worker */
+class ThreadPool {
+  public:
+    typedef std::function<void()> Task;
+
+  private:
+    struct Queue {
+        std::mutex m;
+        std::deque<Task> q;
+    };
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued{0}, next{0};
+    std::mutex sleep_m;
+    std::condition_variable sleep_cv;
+    bool stop = false;
+
+    /* which pool / queue the current thread works for */
+    static inline thread_local ThreadPool *cur_pool = nullptr;
+    static inline thread_local size_t cur_idx = 0;
+
+  public:
+    explicit ThreadPool(size_t n = std::thread::hardware_concurrency()) {
+        n = std::max<size_t>(n, 1);
+        for (size_t i = 0; i < n; i++) {
+            queues.emplace_back(new Queue);
+        }
+        for (size_t i = 0; i < n; i++) {
+            workers.emplace_back([this, i] { work(i); });
+        }
+    }
+    ThreadPool(const ThreadPool &) = delete;
+    ~ThreadPool() {
+        {
+            std::lock_guard lk{sleep_m};
+            stop = true;
+        }
+        sleep_cv.notify_all();
+        for (auto &&w : workers) {
+            w.join();
+        }
+    }
+
+    /* shared by everyone who does not bring a pool of their own */
+    static ThreadPool &global() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    size_t size() const { return workers.size(); }
+
+    void submit(Task task) {
+        size_t idx = cur_pool == this ? cur_idx : next++ % queues.size();
+        {
+            std::lock_guard lk{queues[idx]->m};
+            queues[idx]->q.push_back(std::move(task));
+        }
+        queued++;
+        { std::lock_guard lk{sleep_m}; }
+        sleep_cv.notify_one();
+    }
+
+    /* run one pending task, own deque lifo first, then steal fifo */
+    bool try_run_one() {
+        size_t self = cur_pool == this ? cur_idx : 0;
+        Task task;
+        for (size_t i = 0; i < queues.size() and not task; i++) {
+            auto &&q = *queues[(self + i) % queues.size()];
+            std::lock_guard lk{q.m};
+            if (q.q.empty()) {
+                continue;
+            }
+            if (i == 0) {
+                task = std::move(q.q.back());
+                q.q.pop_back();
+            } else {
+                task = std::move(q.q.front());
+                q.q.pop_front();
+            }
+        }
+        if (not task) {
+            return false;
+        }
+        queued--;
+        task();
+        return true;
+    }
+
+  private:
+    void work(size_t idx) {
+        cur_pool = this;
+        cur_idx = idx;
+        while (true) {
+            if (try_run_one()) {
+                continue;
+            }
+            std::unique_lock lk{sleep_m};
+            sleep_cv.wait(lk, [this] { return stop or queued > 0; });
+            if (stop and queued == 0) {
+                return;
+            }
+        }
+    }
+};
+
+/* tasks forked together and joined together, the joining thread helps out.
+ * the first exception a task throws is kept and rethrown by wait, the other
+ * tasks still run to the end */
+class TaskGroup {
+  private:
+    ThreadPool &pool;
+    std::atomic<size_t> pending{0};
+    std::mutex error_m;
+    std::exception_ptr error;
+
+    void join() {
+        while (pending > 0) {
+            if (not pool.try_run_one()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+  public:
+    explicit TaskGroup(ThreadPool &pool_ = ThreadPool::global()) : pool(pool_) {}
+    /* an error nobody waited for is dropped, the owner is already unwinding */
+    ~TaskGroup() { join(); }
+
+    template <typename F> void run(F &&f) {
+        pending++;
+        pool.submit([this, f = std::forward<F>(f)]() mutable {
+            /* counted down however f leaves, or wait would spin forever */
+            struct Done {
+                std::atomic<size_t> &pending;
+                ~Done() { pending--; }
+            } done{pending};
+            try {
+                f();
+            } catch (...) {
+                std::lock_guard lk{error_m};
+                if (not error) {
+                    error = std::current_exception();
+                }
+            }
+        });
+    }
+
+    void wait() {
+        join();
+        if (error) {
+            std::rethrow_exception(std::exchange(error, nullptr));
+        }
+    }
+
+    ThreadPool &get_pool() { return pool; }
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../common/thread_pool.h"
+#include "table.h"
+
+using namespace std;
+
+/* f(i, i) = 0 and for i < j
+ *     f(i, j) = min over k in [i, j) of merge(merge(f(i, k), f(k + 1, j)), cost)
+ * where cost is cost(i, k, j), or cost(i, j) when it does not depend on the
+ * split. matrix chains, optimal bsts over the gaps between keys and polygon
+ * triangulation over the edges are all this shape, see chain_cost, bst_cost
+ * and polygon_cost below.
+ *
+ * when cost is cost(i, j), merge is plus, and cost is monotone on nested
+ * intervals and satisfies the quadrangle inequality, the first best split is
+ * monotone too (knuth, yao): split(i, j - 1) <= split(i, j) <= split(i + 1, j).
+ * the search is then cut to that range, o(n^2) in total, with the same
+ * values and splits. both conditions are checked on the actual cost before
+ * the sweep. cells on one diagonal are independent and split over the pool.
+ *
+ * values are kept by rows and by columns, so the k loop of a cell reads two
+ * contiguous runs. one packed diagonal-major copy would halve them, but
+ * every read of the k loop would then step to another diagonal, about 10x
+ * slower for matrix chains of 1500. splits are read twice per cell at most
+ * and stay packed by diagonals */
+template <typename V, typename Cost, typename Merge = plus<V>, typename C = uint32_t> class IntervalDp {
+  private:
+    /* split candidates per task, below that a diagonal runs on the calling thread */
+    const static size_t PAR_WORK = 1 << 15;
+    const static bool INTERVAL_COST = invocable<Cost &, size_t, size_t>;
+
+    size_t n;
+    Cost cost;
+    Merge merge;
+    ThreadPool &pool;
+    MirroredTriangle<V> value;
+    Triangle<C> choice;
+    bool knuth = false;
+
+    /* quadrangle inequality and monotonicity, it is enough to look at
+     * neighbouring intervals */
+    bool knuth_applies() {
+        if constexpr (not INTERVAL_COST or not is_same_v<Merge, plus<V>>) {
+            return false;
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                for (size_t j = i + 1; j < n; j++) {
+                    V w = cost(i, j);
+                    if (cost(i + 1, j) > w or cost(i, j - 1) > w) {
+                        return false;
+                    }
+                    if (j + 1 < n and w + cost(i + 1, j + 1) > cost(i, j + 1) + cost(i + 1, j)) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    }
+
+    void cell(size_t i, size_t j) {
+        size_t k0 = i, k1 = j;
+        if (knuth and j - i > 1) {
+            k0 = choice.at(i, j - 1);
+            k1 = choice.at(i + 1, j) + 1;
+        }
+        V best{};
+        size_t best_k = k0;
+        [[maybe_unused]] V w{};
+        if constexpr (INTERVAL_COST) {
+            w = cost(i, j);
+        }
+        const V *row = value.row(i), *col = value.col(j);
+        for (size_t k = k0; k < k1; k++) {
+            V c = merge(row[k], col[k + 1]);
+            if constexpr (INTERVAL_COST) {
+                c = merge(c, w);
+            } else {
+                c = merge(c, cost(i, k, j));
+            }
+            if (k == k0 or c < best) {
+                best = c;
+                best_k = k;
+            }
+        }
+        value.set(i, j, best);
+        choice.at(i, j) = best_k;
+    }
+
+  public:
+    IntervalDp(size_t n_, Cost cost_, Merge merge_ = {}, ThreadPool &pool_ = ThreadPool::global())
+        : n(n_), cost(std::move(cost_)), merge(merge_), pool(pool_), value(n_), choice(n_) {}
+
+    void run() {
+        knuth = knuth_applies();
+        for (size_t len = 1; len < n; len++) {
+            size_t cells = n - len;
+            /* with knuth the ranges of one diagonal telescope to about n */
+            size_t work = knuth ? n + cells : cells * len;
+            if (work < PAR_WORK) {
+                for (size_t i = 0; i < cells; i++) {
+                    cell(i, i + len);
+                }
+                continue;
+            }
+            size_t tasks = min(cells, (work + PAR_WORK - 1) / PAR_WORK);
+            TaskGroup tg{pool};
+            for (size_t t = 0; t < tasks; t++) {
+                size_t begin = cells * t / tasks, end = cells * (t + 1) / tasks;
+                tg.run([this, begin, end, len] {
+                    for (size_t i = begin; i < end; i++) {
+                        cell(i, i + len);
+                    }
+                });
+            }
+            tg.wait();
+        }
+    }
+
+    /* whether run took the knuth-yao shortcut */
+    bool used_knuth() const { return knuth; }
+    const MirroredTriangle<V> &values() const { return value; }
+    /* best split of every interval, k for [i, k] and [k + 1, j] */
+    Triangle<C> &choices() { return choice; }
+};
+
+/* n = dims.size() - 1 matrices, matrix i is dims[i] x dims[i + 1]. the
+ * lambda keeps its own dims, it often outlives a temporary */
+template <typename V> auto chain_cost(vector<size_t> dims) {
+    return [dims = std::move(dims)](size_t i, size_t k, size_t j) {
+        return static_cast<V>(dims[i]) * dims[k + 1] * dims[j + 1];
+    };
+}
+
+/* keys 0..m-1 with access weights p and gaps 0..m with miss weights q.
+ * interval [i, j] of the m + 1 gaps is the subtree over keys i..j-1, a
+ * split at k puts key k at the root. its cost is the total weight below it */
+template <typename V> auto bst_cost(const vector<V> &p, const vector<V> &q) {
+    vector<V> pre{0};
+    for (size_t i = 0; i < q.size(); i++) {
+        pre.push_back(pre.back() + q[i] + (i < p.size() ? p[i] : 0));
+    }
+    /* q[0..j] + p[0..j-1], so that q[i..j] + p[i..j-1] = upto[j] - pre[i]
+     * and the lambda needs nothing of p */
+    vector<V> upto(q.size());
+    for (size_t j = 0; j < q.size(); j++) {
+        upto[j] = pre[j + 1] - (j < p.size() ? p[j] : 0);
+    }
+    return [pre = std::move(pre), upto = std::move(upto)](size_t i, size_t j) { return upto[j] - pre[i]; };
+}
+
+/* polygon with vertices 0..m-1, interval [i, j] of its m - 1 edges spans
+ * vertices i..j+1, a split at k adds triangle (i, k + 1, j + 1) */
+template <typename V, typename W> auto polygon_cost(W weight) {
+    return [weight](size_t i, size_t k, size_t j) { return static_cast<V>(weight(i, k + 1, j + 1)); };
+}
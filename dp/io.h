@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cassert>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+/* read only view of a whole file. the pages are mapped, not copied, and
+ * only faulted in as the parser reaches them */
+class MappedFile {
+    const char *data = nullptr;
+    size_t size = 0;
+
+  public:
+    explicit MappedFile(const string &path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw runtime_error{"cannot open " + path};
+        }
+        struct stat st;
+        if (fstat(fd, &st) < 0) {
+            close(fd);
+            throw runtime_error{"cannot stat " + path};
+        }
+        size = st.st_size;
+        /* mmap refuses empty mappings, an empty file is an empty view */
+        if (size > 0) {
+            void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                throw runtime_error{"cannot map " + path};
+            }
+            madvise(p, size, MADV_SEQUENTIAL);
+            data = static_cast<const char *>(p);
+        }
+        close(fd);
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() {
+        if (data) {
+            munmap(const_cast<char *>(data), size);
+        }
+    }
+
+    string_view view() const { return {data, size}; }
+};
+
+/* whitespace separated tokens of a buffer, one at a time, so a case can be
+ * solved before the next one is read */
+class Scanner {
+    string_view s;
+    size_t pos = 0;
+
+    void skip_space() {
+        while (pos < s.size() and (s[pos] == ' ' or s[pos] == '\n' or s[pos] == '\r' or s[pos] == '\t')) {
+            pos++;
+        }
+    }
+
+  public:
+    explicit Scanner(string_view s_) : s(s_) {}
+
+    /* nothing but whitespace left */
+    bool done() {
+        skip_space();
+        return pos == s.size();
+    }
+
+    string_view word() {
+        skip_space();
+        size_t begin = pos;
+        while (pos < s.size() and not(s[pos] == ' ' or s[pos] == '\n' or s[pos] == '\r' or s[pos] == '\t')) {
+            pos++;
+        }
+        return s.substr(begin, pos - begin);
+    }
+
+    template <unsigned_integral U> U number() {
+        auto w = word();
+        U v;
+        auto [end, ec] = from_chars(w.data(), w.data() + w.size(), v);
+        if (ec != errc{} or end != w.data() + w.size()) {
+            throw runtime_error{"bad number '" + string{w} + "'"};
+        }
+        return v;
+    }
+};
+
+/* collects output in a large buffer and hands it to the stream in big
+ * writes. integers are formatted with to_chars, without locale or sentry
+ * overhead per value */
+class Writer {
+    const static size_t BUF = 1 << 16;
+    ostream &os;
+    string buf;
+
+  public:
+    explicit Writer(ostream &os_) : os(os_) { buf.reserve(BUF); }
+    Writer(const Writer &) = delete;
+    ~Writer() { flush(); }
+
+    void flush() {
+        os.write(buf.data(), buf.size());
+        buf.clear();
+    }
+
+    Writer &operator<<(string_view v) {
+        buf.append(v);
+        if (buf.size() >= BUF) {
+            flush();
+        }
+        return *this;
+    }
+    Writer &operator<<(char c) { return *this << string_view{&c, 1}; }
+    template <integral I> Writer &operator<<(I v) {
+        char tmp[24];
+        auto [end, ec] = to_chars(tmp, tmp + sizeof(tmp), v);
+        assert(ec == errc{});
+        return *this << string_view{tmp, static_cast<size_t>(end - tmp)};
+    }
+    /* to_chars stops at 64 bits, wider values go 19 digits at a time */
+    Writer &operator<<(unsigned __int128 v) {
+        const uint64_t TEN19 = 10000000000000000000u;
+        if (v <= UINT64_MAX) {
+            return *this << static_cast<uint64_t>(v);
+        }
+        *this << v / TEN19;
+        auto low = to_string(static_cast<uint64_t>(v % TEN19));
+        return *this << string(19 - low.length(), '0') << low;
+    }
+};
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../common/thread_pool.h"
+#include "bit_lcs.h"
+
+using namespace std;
+
+/* lcs lengths of many short pairs. LANES pairs of similar length share one
+ * dp: characters are widened to 16 bits and interleaved, so a row of the
+ * batch is a row of vectors and every pair advances one cell per vector op.
+ * shorter pairs are padded with characters that never match, which leaves
+ * their corner value unchanged. batches are spread over the pool, pairs
+ * longer than SHORT_MAX go to the bit-parallel lcs_length instead */
+class BatchLcs {
+  public:
+    constexpr static size_t LANES = 16;
+
+  private:
+    /* a lane does 16 cells per op against 64 for bit-parallel, batching only
+     * wins while per-pair setup dominates. that setup grows with the
+     * alphabet, the measured crossover (-O2, 16k pairs) is near 32 for 4
+     * letters and near 64 for 26, this sits between */
+    const static size_t SHORT_MAX = 48;
+    const static size_t BATCHES_PER_TASK = 8;
+    /* padding of x and y, outside the byte range and different */
+    constexpr static uint16_t PAD_X = 0x100, PAD_Y = 0x200;
+
+    ThreadPool &pool;
+
+    static bool has_avx2() {
+        static const bool avx2 = [] {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        }();
+        return avx2;
+    }
+
+    /* xs is n x LANES, ys is m x LANES, row is m + 1 x LANES and zeroed.
+     * the corner ends up in row[m] */
+    static void lanes_scalar(const uint16_t *xs, size_t n, const uint16_t *ys, size_t m, uint16_t *row) {
+        for (size_t i = 0; i < n; i++) {
+            for (size_t l = 0; l < LANES; l++) {
+                uint16_t left = 0, diag = 0;
+                for (size_t j = 1; j <= m; j++) {
+                    uint16_t up = row[j * LANES + l];
+                    uint16_t d = xs[i * LANES + l] == ys[(j - 1) * LANES + l] ? diag + 1 : 0;
+                    left = max({left, up, d});
+                    row[j * LANES + l] = left;
+                    diag = up;
+                }
+            }
+        }
+    }
+
+    __attribute__((target("avx2"))) static void lanes_avx2(const uint16_t *xs, size_t n, const uint16_t *ys,
+                                                           size_t m, uint16_t *row) {
+        const __m256i one = _mm256_set1_epi16(1);
+        auto v = [](const uint16_t *p) { return reinterpret_cast<const __m256i *>(p); };
+        for (size_t i = 0; i < n; i++) {
+            __m256i x = _mm256_loadu_si256(v(&xs[i * LANES]));
+            __m256i left = _mm256_setzero_si256(), diag = _mm256_setzero_si256();
+            for (size_t j = 1; j <= m; j++) {
+                __m256i up = _mm256_loadu_si256(v(&row[j * LANES]));
+                __m256i match = _mm256_cmpeq_epi16(x, _mm256_loadu_si256(v(&ys[(j - 1) * LANES])));
+                __m256i d = _mm256_and_si256(_mm256_add_epi16(diag, one), match);
+                left = _mm256_max_epu16(_mm256_max_epu16(left, up), d);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(&row[j * LANES]), left);
+                diag = up;
+            }
+        }
+    }
+
+    /* pairs[idx[0, cnt)] in one batch, cnt <= LANES */
+    static void batch(const vector<pair<string, string>> &pairs, const size_t *idx, size_t cnt,
+                      vector<size_t> &res) {
+        size_t n = 0, m = 0;
+        for (size_t l = 0; l < cnt; l++) {
+            n = max(n, pairs[idx[l]].first.length());
+            m = max(m, pairs[idx[l]].second.length());
+        }
+        vector<uint16_t> xs(n * LANES, PAD_X), ys(m * LANES, PAD_Y), row((m + 1) * LANES, 0);
+        for (size_t l = 0; l < cnt; l++) {
+            auto &&[x, y] = pairs[idx[l]];
+            for (size_t i = 0; i < x.length(); i++) {
+                xs[i * LANES + l] = static_cast<unsigned char>(x[i]);
+            }
+            for (size_t j = 0; j < y.length(); j++) {
+                ys[j * LANES + l] = static_cast<unsigned char>(y[j]);
+            }
+        }
+        if (has_avx2() and not scalar_only) {
+            lanes_avx2(xs.data(), n, ys.data(), m, row.data());
+        } else {
+            lanes_scalar(xs.data(), n, ys.data(), m, row.data());
+        }
+        for (size_t l = 0; l < cnt; l++) {
+            res[idx[l]] = row[m * LANES + l];
+        }
+    }
+
+  public:
+    /* tests set this to reach lanes_scalar on avx2 hosts */
+    static inline bool scalar_only = false;
+
+    explicit BatchLcs(ThreadPool &pool_ = ThreadPool::global()) : pool(pool_) {}
+
+    /* lcs length of every pair, in input order */
+    vector<size_t> run(const vector<pair<string, string>> &pairs) {
+        vector<size_t> res(pairs.size());
+        vector<size_t> short_idx, long_idx;
+        for (size_t p = 0; p < pairs.size(); p++) {
+            auto &&[x, y] = pairs[p];
+            if (min(x.length(), y.length()) == 0) {
+                res[p] = 0;
+            } else if (max(x.length(), y.length()) > SHORT_MAX) {
+                long_idx.push_back(p);
+            } else {
+                short_idx.push_back(p);
+            }
+        }
+        /* similar shapes share a batch, so little of it is padding */
+        sort(short_idx.begin(), short_idx.end(), [&](size_t a, size_t b) {
+            return make_pair(pairs[a].first.length(), pairs[a].second.length()) <
+                   make_pair(pairs[b].first.length(), pairs[b].second.length());
+        });
+        const size_t per_task = LANES * BATCHES_PER_TASK;
+        TaskGroup tg{pool};
+        for (size_t begin = 0; begin < long_idx.size(); begin += per_task) {
+            size_t end = min(begin + per_task, long_idx.size());
+            tg.run([&, begin, end] {
+                for (size_t b = begin; b < end; b++) {
+                    res[long_idx[b]] = lcs_length(pairs[long_idx[b]].first, pairs[long_idx[b]].second);
+                }
+            });
+        }
+        for (size_t begin = 0; begin < short_idx.size(); begin += per_task) {
+            size_t end = min(begin + per_task, short_idx.size());
+            tg.run([&, begin, end] {
+                for (size_t b = begin; b < end; b += LANES) {
+                    batch(pairs, &short_idx[b], min(LANES, end - b), res);
+                }
+            });
+        }
+        tg.wait();
+        return res;
+    }
+};
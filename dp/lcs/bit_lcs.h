@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* lcs length only, hyyro's bit-vector form of allison-dix. bit i of v stands
+ * for column i of the shorter string a, each character of b updates the
+ * whole row 64 columns per word with one add and a few logic ops, and no
+ * row of the table is ever stored. memory is one match mask per distinct
+ * character of a, O(sigma * |a| / 64) words */
+inline size_t lcs_length(const string &x, const string &y) {
+    const string &a = x.length() <= y.length() ? x : y;
+    const string &b = x.length() <= y.length() ? y : x;
+    if (a.empty()) {
+        return 0;
+    }
+    size_t words = (a.length() + 63) / 64;
+
+    /* masks only for characters that occur in a */
+    array<int, 256> slot;
+    slot.fill(-1);
+    size_t sigma = 0;
+    for (unsigned char c : a) {
+        if (slot[c] < 0) {
+            slot[c] = sigma++;
+        }
+    }
+    vector<uint64_t> match(sigma * words, 0);
+    for (size_t i = 0; i < a.length(); i++) {
+        match[slot[static_cast<unsigned char>(a[i])] * words + i / 64] |= uint64_t{1} << (i % 64);
+    }
+
+    /* zero bits of v count the lcs so far */
+    vector<uint64_t> v(words, ~uint64_t{0});
+    for (unsigned char c : b) {
+        if (slot[c] < 0) {
+            /* no match anywhere, v would map to itself */
+            continue;
+        }
+        const uint64_t *m = &match[slot[c] * words];
+        unsigned char carry = 0;
+        for (size_t w = 0; w < words; w++) {
+            /* v' = (v + (v & m)) | (v & ~m), the add carried across words */
+            uint64_t u = v[w] & m[w];
+            unsigned long long sum;
+            carry = _addcarry_u64(carry, v[w], u, &sum);
+            v[w] = sum | (v[w] - u);
+        }
+    }
+
+    size_t ones = 0;
+    for (size_t w = 0; w + 1 < words; w++) {
+        ones += popcount(v[w]);
+    }
+    size_t tail = a.length() - 64 * (words - 1);
+    ones += popcount(tail == 64 ? v[words - 1] : v[words - 1] & ((uint64_t{1} << tail) - 1));
+    return a.length() - ones;
+}
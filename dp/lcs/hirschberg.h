@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../../common/thread_pool.h"
+#include "bit_lcs.h"
+
+using namespace std;
+
+/* linear-space lcs reconstruction, hirschberg style divide and conquer that
+ * yields exactly the subsequence pretty_print_solution traces from the full
+ * table. f(i, j) is the lcs of x[0, i) and y[0, j), the traceback walks back
+ * from (|x|, |y|): diagonal on a match, left when f(i, j - 1) > f(i - 1, j),
+ * up otherwise.
+ *
+ * a rectangle [r0, r1] x [c0, c1] comes with f on its top row and left
+ * column and with the two points where the walk enters and leaves it. one
+ * forward pass computes f down to row r1 and, below the middle row, for
+ * every cell the column at which the walk from that cell would first reach
+ * the middle row. that splits the rectangle into two independent halves
+ * holding about half the cells, so the total is still O(|x| |y|), while
+ * only rows and columns of f are ever stored.
+ *
+ * space is O(|x| + |y|), not the O(min(|x|, |y|)) of textbook hirschberg.
+ * matching the full-table walk needs the true f on the top row and left
+ * column of every rectangle, and the pending upper halves on the way down
+ * hold disjoint pieces of both. the output is sized by a bit-parallel
+ * lcs_length pass first, 1/64 of the cell updates */
+class Hirschberg {
+  private:
+    typedef uint32_t cell;
+    /* rectangles up to this many cells are traced from a full table */
+    const static size_t BASE_AREA = 1 << 16;
+    /* halves at least this big go to the pool */
+    const static size_t PAR_AREA = 1 << 22;
+
+    const string &x, &y;
+    string &out;
+    ThreadPool &pool;
+
+    /* cur[1, w) of the row after prev, ys[j] is the character of column j.
+     * a match is a coin flip, so it selects through a mask, not a branch */
+    static void row(char xc, const char *ys, const cell *prev, cell *cur, size_t w) {
+        cell left = cur[0];
+        for (size_t j = 1; j < w; j++) {
+            cell m = -static_cast<cell>(xc == ys[j]);
+            left = ((prev[j - 1] + 1) & m) | (max(left, prev[j]) & ~m);
+            cur[j] = left;
+        }
+    }
+
+    /* walk from (r1, c1) to (r0, c0) on a full table of the rectangle */
+    void trace(size_t r0, size_t r1, size_t c0, size_t c1, const cell *top, const cell *left) {
+        size_t h = r1 - r0 + 1, w = c1 - c0 + 1;
+        vector<cell> f(h * w);
+        copy(top, top + w, f.begin());
+        for (size_t i = 1; i < h; i++) {
+            f[i * w] = left[i];
+            row(x[r0 + i - 1], y.data() + c0 - 1, &f[(i - 1) * w], &f[i * w], w);
+        }
+        size_t i = h - 1, j = w - 1;
+        while (i != 0 or j != 0) {
+            if (i == 0) {
+                j--;
+            } else if (j == 0) {
+                i--;
+            } else if (x[r0 + i - 1] == y[c0 + j - 1]) {
+                out[f[(i - 1) * w + j - 1]] = x[r0 + i - 1];
+                i--;
+                j--;
+            } else if (f[i * w + j - 1] > f[(i - 1) * w + j]) {
+                j--;
+            } else {
+                i--;
+            }
+        }
+    }
+
+    void solve(size_t r0, size_t r1, size_t c0, size_t c1, const cell *top, const cell *left) {
+        size_t h = r1 - r0, w = c1 - c0 + 1;
+        if (h < 2 or h * w <= BASE_AREA) {
+            trace(r0, r1, c0, c1, top, left);
+            return;
+        }
+        size_t mid = r0 + h / 2;
+
+        /* rows r0 + 1 .. r1. g[j] is where the walk from (i, c0 + j) first
+         * reaches row mid, relative to c0 */
+        const char *ys = y.data() + c0 - 1;
+        vector<cell> prev(top, top + w), cur(w), mid_row;
+        vector<cell> g_prev, g_cur(w);
+        for (size_t i = r0 + 1; i <= r1; i++) {
+            char xc = x[i - 1];
+            cur[0] = left[i - r0];
+            row(xc, ys, prev.data(), cur.data(), w);
+            if (i == mid) {
+                mid_row = cur;
+                g_prev.resize(w);
+                for (size_t j = 0; j < w; j++) {
+                    g_prev[j] = j;
+                }
+            } else if (i > mid) {
+                g_cur[0] = g_prev[0];
+                for (size_t j = 1; j < w; j++) {
+                    cell m = -static_cast<cell>(xc == ys[j]);
+                    cell l = -static_cast<cell>(cur[j - 1] > prev[j]);
+                    cell g = (g_cur[j - 1] & l) | (g_prev[j] & ~l);
+                    g_cur[j] = (g_prev[j - 1] & m) | (g & ~m);
+                }
+                g_prev.swap(g_cur);
+            }
+            prev.swap(cur);
+        }
+        size_t split = g_prev[w - 1], cm = c0 + split;
+
+        /* left column of the upper half, f(mid .. r1, cm) */
+        vector<cell> up_left(r1 - mid + 1);
+        up_left[0] = mid_row[split];
+        prev.assign(mid_row.begin(), mid_row.begin() + split + 1);
+        cur.resize(split + 1);
+        for (size_t i = mid + 1; i <= r1; i++) {
+            cur[0] = left[i - r0];
+            row(x[i - 1], ys, prev.data(), cur.data(), split + 1);
+            up_left[i - mid] = cur[split];
+            prev.swap(cur);
+        }
+        /* the temporaries above are dead, only the upper half's boundaries
+         * are kept while the lower half runs */
+        vector<cell> up_top(mid_row.begin() + split, mid_row.end());
+        vector<cell>().swap(mid_row);
+        vector<cell>().swap(prev);
+        vector<cell>().swap(cur);
+        vector<cell>().swap(g_prev);
+        vector<cell>().swap(g_cur);
+
+        auto lower = [&] { solve(r0, mid, c0, cm, top, left); };
+        auto upper = [&] { solve(mid, r1, cm, c1, up_top.data(), up_left.data()); };
+        if ((mid - r0) * (split + 1) >= PAR_AREA and (r1 - mid) * (w - split) >= PAR_AREA) {
+            TaskGroup tg{pool};
+            tg.run(lower);
+            upper();
+            tg.wait();
+        } else {
+            lower();
+            upper();
+        }
+    }
+
+  public:
+    Hirschberg(const string &x_, const string &y_, string &out_, ThreadPool &pool_)
+        : x(x_), y(y_), out(out_), pool(pool_) {}
+
+    void run() {
+        vector<cell> top(y.length() + 1, 0), left(x.length() + 1, 0);
+        solve(0, x.length(), 0, y.length(), top.data(), left.data());
+    }
+};
+
+inline string lcs_hirschberg(const string &x, const string &y, ThreadPool &pool = ThreadPool::global()) {
+    string res(lcs_length(x, y), '\0');
+    if (not res.empty()) {
+        Hirschberg{x, y, res, pool}.run();
+    }
+    return res;
+}
@@ -1,4 +1,10 @@
-#include "table.h"
+#include "batch_lcs.h"
+#include "bit_lcs.h"
+#include "hirschberg.h"
+#include "lcs_dp.h"
+#include "../io.h"
+#include "../table.h"
+#include "wavefront.h"
 #include <cassert>
 #include <chrono>
 #include <cstddef>
@@ -14,21 +20,7 @@
 
 using namespace std;
 
-Table<size_t> lcs_dp(const string &x, const string &y) {
-    Table<size_t> t{x.length() + 1, y.length() + 1};
-    for (auto i : views::iota(1, static_cast<int>(y.length() + 1))) {
-        for (auto j : views::iota(1, static_cast<int>(x.length() + 1))) {
-            if (x[i - 1] == y[j - 1]) {
-                t.at(j, i) = t.at(j - 1, i - 1) + 1;
-            } else {
-                t.at(j, i) = max(t.at(j, i - 1), t.at(j - 1, i));
-            }
-        }
-    }
-    return t;
-}
-
-void print_rectangle(ostream &os, Table<size_t> &t) {
+template <typename T> void print_rectangle(Writer &os, Table<T> &t) {
     for (auto i : views::iota(1, static_cast<int>(t.get_height()))) {
         for (auto j : views::iota(1, static_cast<int>(t.get_width()))) {
             os << t.at(j, i) << ' ';
@@ -39,44 +31,95 @@ void print_rectangle(ostream &os, Table<size_t> &t) {
     }
 }
 
-void pretty_print_solution(ostream &os, Table<size_t> &t, const string &x,
-                           const string &y) {
-    string res; 
-    auto i = x.length();
-    auto j = y.length();
-    while (i != 0 && j != 0) {
-        if (x[i - 1] != y[j - 1]) {
-            if (t.at(j - 1, i) > t.at(j, i - 1)) {
-                j = j - 1;
-            } else {
-                i = i - 1;
+/* pass --length for the length only, without the table and the subsequence,
+ * --hirschberg for the same result files in linear space, without the table,
+ * --wavefront to fill the table by parallel blocks, --batch for the lengths
+ * of all pairs at once into batch_result.txt and batch_time.txt.
+ * --table dumps every table to stdout, it is off by default since the dump
+ * costs far more than the dp. parse, solve and emit totals go to stderr */
+int main(int argc, char *argv[]) {
+    bool length_only = false, linear = false, wavefront = false, batch = false, dump = false;
+    for (auto arg : views::counted(argv + 1, argc - 1)) {
+        string_view a{arg};
+        length_only |= a == "--length";
+        linear |= a == "--hirschberg";
+        wavefront |= a == "--wavefront";
+        batch |= a == "--batch";
+        dump |= a == "--table";
+    }
+    typedef chrono::high_resolution_clock Clock;
+    Clock::duration parse{}, solve{}, emit{};
+    auto t0 = Clock::now();
+    MappedFile in{"../input/2_2_input.txt"};
+    Scanner is{in.view()};
+    if (batch) {
+        vector<pair<string, string>> pairs;
+        while (not is.done()) {
+            is.number<size_t>();
+            string x{is.word()};
+            string y{is.word()};
+            pairs.emplace_back(std::move(x), std::move(y));
+        }
+        auto t1 = Clock::now();
+        auto res = BatchLcs{}.run(pairs);
+        auto t2 = Clock::now();
+        {
+            ofstream file("../output/batch_result.txt");
+            Writer os{file};
+            for (auto len : res) {
+                os << len << '\n';
             }
-        } else {
-            res.push_back(x[i - 1]);
-            i = i - 1;
-            j = j - 1;
         }
+        auto ns = chrono::duration_cast<chrono::nanoseconds>(t2 - t1).count();
+        ofstream os_t("../output/batch_time.txt");
+        os_t << pairs.size() << " pairs\n"
+             << ns << "ns\n"
+             << (ns > 0 ? pairs.size() * 1e9 / ns : 0) << " pairs/s\n";
+        cerr << "parse " << t1 - t0 << ", solve " << t2 - t1 << ", emit " << Clock::now() - t2 << '\n';
+        return 0;
     }
-    os << string(res.rbegin(), res.rend());
-}
-
-int main() {
-    ifstream is{"../input/2_2_input.txt"};
     ofstream os_t("../output/time.txt");
-    while (not(is.peek(), is.eof())) {
-        int cnt;
-        is >> cnt; // ignore length here as we already get the string
-        string x, y;
-        is >> x >> y;
-        typedef chrono::high_resolution_clock Clock;
+    Writer out{cout};
+    while (not is.done()) {
+        auto cnt = is.number<size_t>(); // ignore length here as we already get the string
+        string x{is.word()};
+        string y{is.word()};
         auto t1 = Clock::now();
-        auto table = lcs_dp(x, y);
-        auto t2 = Clock::now();
-        os_t << t2 - t1 << '\n';
-        print_rectangle(cout, table);
-        cout << '\n';
-        ofstream os("../output/result_" + to_string(cnt) + ".txt");
-        os << table.at(cnt, cnt) << '\n';
-        pretty_print_solution(os, table, x, y);
+        parse += t1 - t0;
+        Clock::duration case_solve;
+        ofstream file("../output/result_" + to_string(cnt) + ".txt");
+        Writer os{file};
+        if (length_only) {
+            auto len = lcs_length(x, y);
+            auto t2 = Clock::now();
+            case_solve = t2 - t1;
+            os << len << '\n';
+        } else if (linear) {
+            auto res = lcs_hirschberg(x, y);
+            auto t2 = Clock::now();
+            case_solve = t2 - t1;
+            os << res.length() << '\n' << res;
+        } else {
+            /* no cell exceeds the shorter length */
+            with_cell_type(min(x.length(), y.length()), [&](auto cell) {
+                typedef decltype(cell) T;
+                auto table = wavefront ? lcs_wavefront<T>(x, y) : lcs_dp<T>(x, y);
+                auto t2 = Clock::now();
+                case_solve = t2 - t1;
+                if (dump) {
+                    print_rectangle(out, table);
+                    out << '\n';
+                }
+                os << table.at(y.length(), x.length()) << '\n';
+                pretty_print_solution(os, table, x, y);
+            });
+        }
+        os.flush();
+        os_t << case_solve << '\n';
+        t0 = Clock::now();
+        solve += case_solve;
+        emit += t0 - t1 - case_solve;
     }
-}
\ No newline at end of file
+    out.flush();
+    cerr << "parse " << parse << ", solve " << solve << ", emit " << emit << '\n';
+}
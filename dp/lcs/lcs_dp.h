@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <ranges>
+#include <string>
+
+#include "../io.h"
+#include "../table.h"
+
+using namespace std;
+
+/* the full lcs table, at(j, i) is the lcs of x[0, i) and y[0, j): one row
+ * per prefix of x, one column per prefix of y */
+template <typename T> Table<T> lcs_dp(const string &x, const string &y) {
+    Table<T> t{y.length() + 1, x.length() + 1};
+    for (auto i : views::iota(1, static_cast<int>(x.length() + 1))) {
+        for (auto j : views::iota(1, static_cast<int>(y.length() + 1))) {
+            if (x[i - 1] == y[j - 1]) {
+                t.at(j, i) = t.at(j - 1, i - 1) + 1;
+            } else {
+                t.at(j, i) = max(t.at(j, i - 1), t.at(j - 1, i));
+            }
+        }
+    }
+    return t;
+}
+
+/* walks back from the corner: diagonal on a match, left when that cell is
+ * strictly larger, up otherwise */
+template <typename T>
+void pretty_print_solution(Writer &os, Table<T> &t, const string &x, const string &y) {
+    string res;
+    auto i = x.length();
+    auto j = y.length();
+    while (i != 0 && j != 0) {
+        if (x[i - 1] != y[j - 1]) {
+            if (t.at(j - 1, i) > t.at(j, i - 1)) {
+                j = j - 1;
+            } else {
+                i = i - 1;
+            }
+        } else {
+            res.push_back(x[i - 1]);
+            i = i - 1;
+            j = j - 1;
+        }
+    }
+    os << string(res.rbegin(), res.rend());
+}
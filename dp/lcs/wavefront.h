@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+#include <memory>
+#include <string>
+
+#include "../../common/thread_pool.h"
+#include "../table.h"
+
+using namespace std;
+
+/* fills the same table as lcs_dp, but in TILE x TILE blocks. a block only
+ * needs the blocks above and to its left, so blocks on one anti-diagonal
+ * are independent: every block counts down its two dependencies and is
+ * handed to the pool by whichever neighbour finishes last.
+ *
+ * inside a block every row is two passes. the first takes max(up, diagonal
+ * + 1 on a match) for the whole row at once, 32 bytes of cells per avx2
+ * register, the second carries the running max from the left. the max of
+ * the three neighbours equals the lcs recurrence since a match is never
+ * worse */
+template <typename T> class Wavefront {
+    static_assert(is_unsigned_v<T> and (sizeof(T) == 2 or sizeof(T) == 4 or sizeof(T) == 8));
+
+  private:
+    /* 128 x 128 cells of at most 8 bytes, a block stays in l2 */
+    const static size_t TILE = 128;
+
+    Table<T> &t;
+    const string &x, &y;
+    ThreadPool &pool;
+    size_t tile_rows, tile_cols;
+    unique_ptr<atomic<unsigned char>[]> deps;
+
+    static bool has_avx2() {
+        static const bool avx2 = [] {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        }();
+        return avx2;
+    }
+
+    /* cur[j] = max(prev[j], prev[j - 1] + 1 if xc == ys[j]), j in [0, n) */
+    static void up_diag_scalar(char xc, const char *ys, const T *prev, T *cur, size_t n) {
+        for (size_t j = 0; j < n; j++) {
+            T m = -static_cast<T>(xc == ys[j]);
+            cur[j] = max<T>(prev[j], (prev[j - 1] + 1) & m);
+        }
+    }
+
+    __attribute__((target("avx2"))) static void up_diag_avx2(char xc, const char *ys, const T *prev,
+                                                             T *cur, size_t n) {
+        const size_t LANES = 32 / sizeof(T);
+        size_t j = 0;
+        for (; j + LANES <= n; j += LANES) {
+            __m256i up = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&prev[j]));
+            __m256i diag = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&prev[j - 1]));
+            __m256i res;
+            if constexpr (sizeof(T) == 2) {
+                __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&ys[j]));
+                __m256i m = _mm256_cmpeq_epi16(_mm256_cvtepi8_epi16(chars), _mm256_set1_epi16(xc));
+                diag = _mm256_and_si256(_mm256_add_epi16(diag, _mm256_set1_epi16(1)), m);
+                res = _mm256_max_epu16(up, diag);
+            } else if constexpr (sizeof(T) == 4) {
+                __m128i chars = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(&ys[j]));
+                __m256i m = _mm256_cmpeq_epi32(_mm256_cvtepi8_epi32(chars), _mm256_set1_epi32(xc));
+                diag = _mm256_and_si256(_mm256_add_epi32(diag, _mm256_set1_epi32(1)), m);
+                res = _mm256_max_epu32(up, diag);
+            } else {
+                int32_t four;
+                memcpy(&four, &ys[j], 4);
+                __m256i m = _mm256_cmpeq_epi64(_mm256_cvtepi8_epi64(_mm_cvtsi32_si128(four)),
+                                               _mm256_set1_epi64x(xc));
+                diag = _mm256_and_si256(_mm256_add_epi64(diag, _mm256_set1_epi64x(1)), m);
+                /* cells are far below 2^63, a signed compare is enough */
+                res = _mm256_blendv_epi8(up, diag, _mm256_cmpgt_epi64(diag, up));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(&cur[j]), res);
+        }
+        up_diag_scalar(xc, &ys[j], &prev[j], &cur[j], n - j);
+    }
+
+    void block(size_t ti, size_t tj) {
+        size_t i0 = 1 + ti * TILE, i1 = min(i0 + TILE, t.get_height());
+        size_t j0 = 1 + tj * TILE, j1 = min(j0 + TILE, t.get_width());
+        for (size_t i = i0; i < i1; i++) {
+            const T *prev = t.row(i - 1);
+            T *cur = t.row(i);
+            /* same character pairing as lcs_dp */
+            const char *ys = y.data() - 1;
+            if (has_avx2() and not scalar_only) {
+                up_diag_avx2(x[i - 1], &ys[j0], &prev[j0], &cur[j0], j1 - j0);
+            } else {
+                up_diag_scalar(x[i - 1], &ys[j0], &prev[j0], &cur[j0], j1 - j0);
+            }
+            for (size_t j = j0; j < j1; j++) {
+                cur[j] = max(cur[j], cur[j - 1]);
+            }
+        }
+    }
+
+    void run_block(size_t ti, size_t tj, TaskGroup &tg) {
+        block(ti, tj);
+        /* release right and lower neighbours, the last releaser runs it */
+        if (tj + 1 < tile_cols and --deps[ti * tile_cols + tj + 1] == 0) {
+            tg.run([this, ti, tj, &tg] { run_block(ti, tj + 1, tg); });
+        }
+        if (ti + 1 < tile_rows and --deps[(ti + 1) * tile_cols + tj] == 0) {
+            tg.run([this, ti, tj, &tg] { run_block(ti + 1, tj, tg); });
+        }
+    }
+
+  public:
+    /* tests set this to reach up_diag_scalar on avx2 hosts */
+    static inline bool scalar_only = false;
+
+    Wavefront(Table<T> &t_, const string &x_, const string &y_, ThreadPool &pool_)
+        : t(t_), x(x_), y(y_), pool(pool_) {
+        tile_rows = (t.get_height() - 1 + TILE - 1) / TILE;
+        tile_cols = (t.get_width() - 1 + TILE - 1) / TILE;
+        deps.reset(new atomic<unsigned char>[tile_rows * tile_cols]);
+        for (size_t ti = 0; ti < tile_rows; ti++) {
+            for (size_t tj = 0; tj < tile_cols; tj++) {
+                deps[ti * tile_cols + tj] = (ti > 0) + (tj > 0);
+            }
+        }
+    }
+
+    void run() {
+        if (tile_rows == 0 or tile_cols == 0) {
+            return;
+        }
+        TaskGroup tg{pool};
+        run_block(0, 0, tg);
+        tg.wait();
+    }
+};
+
+template <typename T>
+Table<T> lcs_wavefront(const string &x, const string &y, ThreadPool &pool = ThreadPool::global()) {
+    Table<T> t{y.length() + 1, x.length() + 1};
+    Wavefront<T>{t, x, y, pool}.run();
+    return t;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "../../common/thread_pool.h"
+#include "../table.h"
+
+using namespace std;
+
+/* cost of chaining matrices i..j is m[i][j], stored twice in a square
+ * table: at (j, i), so row i holds m[i][k] for growing k, and at (i, j), so
+ * row j holds m[k + 1][j] for growing k. the k loop of a cell then reads two
+ * contiguous rows and the dims, and is a plain vector min reduction.
+ *
+ * a sweep by diagonals reads two whole rows per cell and reuses neither, so
+ * past the caches it runs at memory speed. the cells are swept in TILE x
+ * TILE tiles instead, one diagonal of tiles after the other. the k range of
+ * a tile that lies strictly between its rows and columns only needs
+ * finished tiles, it is walked in CHUNK steps for all cells of the tile
+ * while those row pieces stay in l2. the rest of each cell's k range is in
+ * the tile itself and in the two diagonal tiles, it is finished cell by cell
+ * bottom up and left to right. tiles of one diagonal go to the pool */
+template <typename V, typename C> class ChainDp {
+    static_assert(is_same_v<V, uint64_t> or is_same_v<V, unsigned __int128>);
+
+  private:
+    typedef pair<V, size_t> Best;
+    /* k steps per task, below that a diagonal of tiles runs on the calling thread */
+    const static size_t PAR_WORK = 1 << 15;
+    const static size_t TILE = 64;
+    /* 2 * TILE row pieces of CHUNK costs are a quarter of a 2 MiB l2 */
+    const static size_t CHUNK = 256;
+
+    const vector<size_t> &mats;
+    Table<V> &cost;
+    Table<C> &choice;
+    ThreadPool &pool;
+
+    static bool has_avx2() {
+        static const bool avx2 = [] {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        }();
+        return avx2;
+    }
+
+    /* best is the min and first argmin over the k before k0, folded with the
+     * split costs over k in [k0, k1) */
+    Best best_scalar(size_t i, size_t j, size_t k0, size_t k1, Best best) {
+        const V *left = cost.row(i), *right = cost.row(j);
+        V pij = static_cast<V>(mats[i]) * mats[j + 1];
+        for (size_t k = k0; k < k1; k++) {
+            V c = left[k] + right[k + 1] + pij * mats[k + 1];
+            if (c < best.first) {
+                best = {c, k};
+            }
+        }
+        return best;
+    }
+
+    /* every candidate is below 2^63, so signed compares order them, and
+     * every dim is below 2^21. avx2 has no 64 bit multiply, pij * d is put
+     * together from the 32 bit halves of pij */
+    __attribute__((target("avx2"))) Best best_avx2(size_t i, size_t j, size_t k0, size_t k1, Best prev) {
+        const V *left = cost.row(i), *right = cost.row(j);
+        __m256i pij = _mm256_set1_epi64x(mats[i] * mats[j + 1]);
+        __m256i pij_hi = _mm256_srli_epi64(pij, 32);
+        __m256i best = _mm256_set1_epi64x(INT64_MAX);
+        __m256i best_k = _mm256_setzero_si256();
+        __m256i ks = _mm256_setr_epi64x(k0, k0 + 1, k0 + 2, k0 + 3);
+        const __m256i four = _mm256_set1_epi64x(4);
+        size_t k = k0;
+        for (; k + 4 <= k1; k += 4) {
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&mats[k + 1]));
+            __m256i c = _mm256_add_epi64(_mm256_mul_epu32(pij, d),
+                                         _mm256_slli_epi64(_mm256_mul_epu32(pij_hi, d), 32));
+            __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&left[k]));
+            __m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&right[k + 1]));
+            c = _mm256_add_epi64(c, _mm256_add_epi64(l, r));
+            /* strictly smaller only, a lane keeps its first k */
+            __m256i lt = _mm256_cmpgt_epi64(best, c);
+            best = _mm256_blendv_epi8(best, c, lt);
+            best_k = _mm256_blendv_epi8(best_k, ks, lt);
+            ks = _mm256_add_epi64(ks, four);
+        }
+        alignas(32) uint64_t vals[4], idx[4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(vals), best);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(idx), best_k);
+        V b = INT64_MAX;
+        size_t b_k = 0;
+        for (size_t l = 0; l < 4; l++) {
+            if (vals[l] < b or (vals[l] == b and idx[l] < b_k)) {
+                b = vals[l];
+                b_k = idx[l];
+            }
+        }
+        /* the earlier k of prev win ties */
+        if (b < prev.first) {
+            prev = {b, b_k};
+        }
+        return best_scalar(i, j, k, k1, prev);
+    }
+
+    Best best(size_t i, size_t j, size_t k0, size_t k1, Best prev) {
+        if constexpr (is_same_v<V, uint64_t>) {
+            if (has_avx2() and k1 - k0 >= 4) {
+                return best_avx2(i, j, k0, k1, prev);
+            }
+        }
+        return best_scalar(i, j, k0, k1, prev);
+    }
+
+    void store(size_t i, size_t j, Best res) {
+        cost.at(j, i) = cost.at(i, j) = res.first;
+        choice.at(i, j) = res.second;
+    }
+
+    /* tile (a, a), every split of its cells is inside it */
+    void diagonal_tile(size_t a, size_t mat_num) {
+        size_t i0 = a * TILE, i1 = min(i0 + TILE, mat_num);
+        for (size_t len = 1; len < i1 - i0; len++) {
+            for (size_t i = i0; i + len < i1; i++) {
+                store(i, i + len, best(i, i + len, i, i + len, {~V{0}, i}));
+            }
+        }
+    }
+
+    /* tile (a, b) with a < b, rows [i0, i1) and columns [j0, j1) */
+    void tile(size_t a, size_t b, size_t mat_num, vector<Best> &acc) {
+        size_t i0 = a * TILE, i1 = i0 + TILE, j0 = b * TILE, j1 = min(j0 + TILE, mat_num);
+        acc.assign(TILE * TILE, {~V{0}, 0});
+        /* k in [i1, j0), every split lands in finished tiles */
+        for (size_t k0 = i1; k0 < j0; k0 += CHUNK) {
+            size_t k1 = min(k0 + CHUNK, j0);
+            for (size_t i = i0; i < i1; i++) {
+                for (size_t j = j0; j < j1; j++) {
+                    Best &c = acc[(i - i0) * TILE + j - j0];
+                    c = best(i, j, k0, k1, c);
+                }
+            }
+        }
+        /* k in [i, i1) reads the cells below in this column, k in [j0, j)
+         * the cells to the left in this row */
+        for (size_t i = i1; i-- > i0;) {
+            for (size_t j = j0; j < j1; j++) {
+                Best lo = best(i, j, i, i1, {~V{0}, i});
+                Best mid = acc[(i - i0) * TILE + j - j0];
+                store(i, j, best(i, j, j0, j, lo.first <= mid.first ? lo : mid));
+            }
+        }
+    }
+
+  public:
+    ChainDp(const vector<size_t> &mats_, Table<V> &cost_, Table<C> &choice_, ThreadPool &pool_)
+        : mats(mats_), cost(cost_), choice(choice_), pool(pool_) {}
+
+    void run() {
+        size_t mat_num = mats.size() - 1, tiles = (mat_num + TILE - 1) / TILE;
+        for (size_t a = 0; a < tiles; a++) {
+            diagonal_tile(a, mat_num);
+        }
+        vector<Best> acc;
+        for (size_t d = 1; d < tiles; d++) {
+            /* about TILE^3 * d k steps per tile */
+            if ((tiles - d) * d * TILE * TILE * TILE < PAR_WORK) {
+                for (size_t a = 0; a + d < tiles; a++) {
+                    tile(a, a + d, mat_num, acc);
+                }
+                continue;
+            }
+            TaskGroup tg{pool};
+            for (size_t a = 0; a + d < tiles; a++) {
+                tg.run([this, a, d, mat_num] {
+                    vector<Best> acc;
+                    tile(a, a + d, mat_num, acc);
+                });
+            }
+            tg.wait();
+        }
+    }
+};
+
+/* call f with the narrowest cost type that holds every split cost of the
+ * chain. a split of i..j costs at most (j - i) * max_dim^3, so the bound is
+ * checked once up front instead of on every add. uint64_t is only picked
+ * below 2^63, which lets the avx2 loop compare signed */
+template <typename F> decltype(auto) with_cost_type(const vector<size_t> &mats, F &&f) {
+    typedef unsigned __int128 u128;
+    u128 d = *max_element(mats.begin(), mats.end());
+    u128 bound = 0;
+    if (__builtin_mul_overflow(d, d, &bound) or __builtin_mul_overflow(bound, d, &bound) or
+        __builtin_mul_overflow(bound, static_cast<u128>(mats.size() - 1), &bound)) {
+        throw overflow_error{"matrix chain cost does not fit in 128 bits"};
+    }
+    if (bound <= INT64_MAX) {
+        return f(uint64_t{});
+    }
+    return f(u128{});
+}
+
+/* V holds a cost, C a split point, any type that can index the chain */
+template <typename V, typename C>
+pair<Table<V>, Table<C>> mat_mul_dp(const vector<size_t> &mats, ThreadPool &pool = ThreadPool::global()) {
+    auto mat_num = mats.size() - 1;
+    Table<V> cost(mat_num, mat_num);
+    Table<C> choice(mat_num, mat_num);
+    ChainDp<V, C>{mats, cost, choice, pool}.run();
+    return {std::move(cost), std::move(choice)};
+}
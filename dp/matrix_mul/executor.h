@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "../../common/thread_pool.h"
+#include "gemm.h"
+
+using namespace std;
+
+/* one allocation for every intermediate product of a plan. the plan fixes
+ * all shapes up front, so each product gets its own slice and concurrent
+ * subtrees never share memory */
+class Arena {
+    double *base = nullptr;
+    size_t cells = 0;
+
+  public:
+    explicit Arena(size_t cells_) : cells(cells_) {
+        base = static_cast<double *>(operator new(max<size_t>(cells, 1) * sizeof(double), align_val_t{64}));
+    }
+    Arena(const Arena &) = delete;
+    ~Arena() { operator delete(base, align_val_t{64}); }
+
+    double *at(size_t offset) { return base + offset; }
+    size_t size() const { return cells; }
+};
+
+/* multiplies a chain out along a plan. matrix i is dims[i] x dims[i + 1],
+ * row-major, and plan.at(i, j) is the split of [i, j] as in a choice Table,
+ * a Triangle or a SplitMap. each product is one blocked gemm into its arena
+ * slice, handed to the pool once both of its operands are done. the two
+ * sides of every split run concurrently, and a plan as deep as the chain
+ * never recurses */
+template <typename Plan> class ChainExecutor {
+  private:
+    const static size_t LEAF = SIZE_MAX;
+
+    struct Node {
+        size_t i, j;
+        /* children, LEAF for an input matrix */
+        size_t left = LEAF, right = LEAF;
+        size_t parent = LEAF;
+        size_t offset = 0;
+    };
+
+    const vector<size_t> &dims;
+    const vector<const double *> &leaves;
+    ThreadPool &pool;
+    vector<Node> nodes;
+    size_t cells = 0;
+    uint64_t mults = 0;
+    Arena arena;
+
+    /* the product tree in pre-order, with arena slices and the multiply
+     * count, without recursing down a deep tree */
+    size_t build(const Plan &plan) {
+        size_t n = dims.size() - 1;
+        if (n < 2) {
+            return 0;
+        }
+        nodes.push_back({0, n - 1});
+        for (size_t v = 0; v < nodes.size(); v++) {
+            size_t i = nodes[v].i, j = nodes[v].j;
+            size_t k = plan.at(i, j);
+            nodes[v].offset = cells;
+            cells += dims[i] * dims[j + 1];
+            mults += static_cast<uint64_t>(dims[i]) * dims[k + 1] * dims[j + 1];
+            if (k > i) {
+                nodes[v].left = nodes.size();
+                nodes.push_back({i, k, LEAF, LEAF, v});
+            }
+            if (k + 1 < j) {
+                nodes[v].right = nodes.size();
+                nodes.push_back({k + 1, j, LEAF, LEAF, v});
+            }
+        }
+        return cells;
+    }
+
+    /* rows x cols of node v, or of the leaf at i when v is LEAF */
+    const double *result(size_t v, size_t i) { return v == LEAF ? leaves[i] : arena.at(nodes[v].offset); }
+
+    /* product v, its operands are done. the parent follows as a new task
+     * once its other operand is done as well */
+    void run_node(size_t v, vector<atomic<uint8_t>> &waiting, TaskGroup &tg) {
+        Node &node = nodes[v];
+        size_t k = node.left == LEAF ? node.i : nodes[node.left].j;
+        size_t m = dims[node.i], inner = dims[k + 1], n = dims[node.j + 1];
+        Gemm::multiply(result(node.left, node.i), inner, result(node.right, k + 1), n, arena.at(node.offset), n, m,
+                       inner, n, pool);
+        size_t p = node.parent;
+        if (p != LEAF and --waiting[p] == 0) {
+            tg.run([this, p, &waiting, &tg] { run_node(p, waiting, tg); });
+        }
+    }
+
+  public:
+    ChainExecutor(const vector<size_t> &dims_, const Plan &plan, const vector<const double *> &leaves_,
+                  ThreadPool &pool_ = ThreadPool::global())
+        : dims(dims_), leaves(leaves_), pool(pool_), arena(build(plan)) {}
+
+    /* scalar multiplies the plan costs, the dp's prediction */
+    uint64_t multiplies() const { return mults; }
+    size_t arena_bytes() const { return arena.size() * sizeof(double); }
+
+    /* the dims[0] x dims[n] product */
+    const double *run() {
+        if (nodes.empty()) {
+            return leaves[0];
+        }
+        /* operands of each product still being computed */
+        vector<atomic<uint8_t>> waiting(nodes.size());
+        for (size_t v = 0; v < nodes.size(); v++) {
+            waiting[v] = (nodes[v].left != LEAF) + (nodes[v].right != LEAF);
+        }
+        TaskGroup tg{pool};
+        for (size_t v = 0; v < nodes.size(); v++) {
+            if (nodes[v].left == LEAF and nodes[v].right == LEAF) {
+                tg.run([this, v, &waiting, &tg] { run_node(v, waiting, tg); });
+            }
+        }
+        tg.wait();
+        return arena.at(nodes[0].offset);
+    }
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <immintrin.h>
+#include <vector>
+
+#include "../../common/thread_pool.h"
+
+using namespace std;
+
+/* c = a * b for row-major doubles, a is m x k, b is k x n, c is m x n, each
+ * with its own row stride. blocked like goto's gemm: a KC x NC panel of b and
+ * an MC x KC block of a are packed so the micro kernel streams both from
+ * cache, the kernel keeps an MR x NR tile of c in registers. the column
+ * panels of c are independent and go to the pool */
+class Gemm {
+  public:
+    constexpr static size_t MR = 6, NR = 8;
+
+  private:
+    /* a block of a stays in l2, a sliver of b in l1 */
+    constexpr static size_t KC = 256, MC = 96, NC = 2048;
+
+    static bool has_avx2() {
+        static const bool avx2 = [] {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma");
+        }();
+        return avx2;
+    }
+
+    /* mc x kc of a into MR row slivers, short slivers padded with zeros */
+    static void pack_a(const double *a, size_t lda, size_t mc, size_t kc, double *to) {
+        for (size_t i = 0; i < mc; i += MR) {
+            for (size_t l = 0; l < kc; l++) {
+                for (size_t r = 0; r < MR; r++) {
+                    *to++ = i + r < mc ? a[(i + r) * lda + l] : 0;
+                }
+            }
+        }
+    }
+
+    /* kc x nc of b into NR column slivers, short slivers padded with zeros */
+    static void pack_b(const double *b, size_t ldb, size_t kc, size_t nc, double *to) {
+        for (size_t j = 0; j < nc; j += NR) {
+            for (size_t l = 0; l < kc; l++) {
+                for (size_t c = 0; c < NR; c++) {
+                    *to++ = j + c < nc ? b[l * ldb + j + c] : 0;
+                }
+            }
+        }
+    }
+
+    /* tile = sliver of a * sliver of b, MR x NR with row stride NR */
+    static void kernel_scalar(size_t kc, const double *a, const double *b, double *tile) {
+        fill(tile, tile + MR * NR, 0.0);
+        for (size_t l = 0; l < kc; l++) {
+            for (size_t r = 0; r < MR; r++) {
+                for (size_t c = 0; c < NR; c++) {
+                    tile[r * NR + c] += a[l * MR + r] * b[l * NR + c];
+                }
+            }
+        }
+    }
+
+    __attribute__((target("avx2,fma"))) static void kernel_avx2(size_t kc, const double *a, const double *b,
+                                                                double *tile) {
+        __m256d acc[MR][2];
+        for (size_t r = 0; r < MR; r++) {
+            acc[r][0] = acc[r][1] = _mm256_setzero_pd();
+        }
+        for (size_t l = 0; l < kc; l++) {
+            __m256d b0 = _mm256_loadu_pd(&b[l * NR]), b1 = _mm256_loadu_pd(&b[l * NR + 4]);
+            for (size_t r = 0; r < MR; r++) {
+                __m256d ar = _mm256_broadcast_sd(&a[l * MR + r]);
+                acc[r][0] = _mm256_fmadd_pd(ar, b0, acc[r][0]);
+                acc[r][1] = _mm256_fmadd_pd(ar, b1, acc[r][1]);
+            }
+        }
+        for (size_t r = 0; r < MR; r++) {
+            _mm256_storeu_pd(&tile[r * NR], acc[r][0]);
+            _mm256_storeu_pd(&tile[r * NR + 4], acc[r][1]);
+        }
+    }
+
+    /* columns [j0, j1) of c, all rows */
+    static void panel(const double *a, size_t lda, const double *b, size_t ldb, double *c, size_t ldc, size_t m,
+                      size_t k, size_t j0, size_t j1) {
+        /* no slice of k to write c, the empty product is zero */
+        if (k == 0) {
+            for (size_t i = 0; i < m; i++) {
+                fill(&c[i * ldc + j0], &c[i * ldc + j1], 0.0);
+            }
+            return;
+        }
+        /* grown to the largest blocks seen, a small product stays cheap */
+        thread_local vector<double> packed_a, packed_b;
+        size_t kc_max = min(KC, k);
+        packed_a.resize(max(packed_a.size(), (min(MC, m) + MR - 1) / MR * MR * kc_max));
+        packed_b.resize(max(packed_b.size(), (min(NC, j1 - j0) + NR - 1) / NR * NR * kc_max));
+        double tile[MR * NR];
+        bool avx2 = has_avx2() and not scalar_only;
+        for (size_t jc = j0; jc < j1; jc += NC) {
+            size_t nc = min(NC, j1 - jc);
+            for (size_t pc = 0; pc < k; pc += KC) {
+                size_t kc = min(KC, k - pc);
+                pack_b(&b[pc * ldb + jc], ldb, kc, nc, packed_b.data());
+                for (size_t ic = 0; ic < m; ic += MC) {
+                    size_t mc = min(MC, m - ic);
+                    pack_a(&a[ic * lda + pc], lda, mc, kc, packed_a.data());
+                    for (size_t jr = 0; jr < nc; jr += NR) {
+                        for (size_t ir = 0; ir < mc; ir += MR) {
+                            const double *sa = &packed_a[ir * kc], *sb = &packed_b[jr * kc];
+                            if (avx2) {
+                                kernel_avx2(kc, sa, sb, tile);
+                            } else {
+                                kernel_scalar(kc, sa, sb, tile);
+                            }
+                            /* the first slice of k writes c, the others add */
+                            size_t rows = min(MR, mc - ir), cols = min(NR, nc - jr);
+                            for (size_t r = 0; r < rows; r++) {
+                                double *to = &c[(ic + ir + r) * ldc + jc + jr];
+                                for (size_t col = 0; col < cols; col++) {
+                                    to[col] = pc == 0 ? tile[r * NR + col] : to[col] + tile[r * NR + col];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+  public:
+    /* tests set this to reach kernel_scalar on avx2 hosts */
+    static inline bool scalar_only = false;
+
+    static void multiply(const double *a, size_t lda, const double *b, size_t ldb, double *c, size_t ldc, size_t m,
+                         size_t k, size_t n, ThreadPool &pool = ThreadPool::global()) {
+        /* enough column panels to keep the pool busy, whole NR slivers each */
+        size_t width = (n + pool.size() - 1) / pool.size();
+        width = min(NC, max(NR * 8, (width + NR - 1) / NR * NR));
+        if (width >= n or m * k * n < (1 << 18)) {
+            panel(a, lda, b, ldb, c, ldc, m, k, 0, n);
+            return;
+        }
+        TaskGroup tg{pool};
+        for (size_t j = 0; j < n; j += width) {
+            tg.run([=] { panel(a, lda, b, ldb, c, ldc, m, k, j, min(n, j + width)); });
+        }
+        tg.wait();
+    }
+};
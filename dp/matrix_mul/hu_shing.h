@@ -0,0 +1,283 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/* best split of the intervals one parenthesisation uses, for chains far too
+ * long for a dense table. reads like a choice Table in pretty_print_solution */
+class SplitMap {
+    unordered_map<size_t, size_t> split;
+    size_t n;
+
+  public:
+    explicit SplitMap(size_t n_) : n(n_) { split.reserve(n_); }
+
+    void set(size_t i, size_t j, size_t k) { split[i * n + j] = k; }
+    size_t at(size_t i, size_t j) const { return split.at(i * n + j); }
+    size_t get_width() const { return n; }
+};
+
+/* hu and shing: the chain is the polygon of its n + 1 dims, every
+ * parenthesisation a triangulation, and a triangle costs the product of its
+ * corners. rotated so vertex 0 is the lightest, with ties broken by
+ * position, an arc (a, b) can only be in an optimal triangulation when every
+ * vertex between a and b is heavier than both ends. one sweep with a stack
+ * finds these h-arcs, at most n, and they nest into a tree.
+ *
+ * an optimal triangulation keeps some of the h-arcs, and every region
+ * between a kept arc and the kept arcs right above it is a fan from its
+ * lightest corner. going up from the leaves, a region with apex weight y
+ * drops an arc d of its ceiling exactly when fanning d's region from y
+ * costs no more, that is when the supporting weight
+ *     s(d) = fan(d) / (boundary(d) - w(d))
+ * is at least y. dropping d exposes d's own ceiling, so each region keeps
+ * its ceiling in a leftist max heap on s and pops while the top qualifies.
+ *
+ * an arc e right above d with s(e) >= s(d) falls whenever d does, as the
+ * apex that drops d is light enough for e too. so e joins d's group, which
+ * sums fans and denominators, and the group's weight rises towards s(e)
+ * until the rest of the ceiling is below it. groups fall as one. every arc
+ * enters and leaves a heap once, o(n log n) overall.
+ *
+ * V must hold every cost of the chain, see with_cost_type */
+template <typename V> class HuShing {
+  private:
+    const static size_t NONE = SIZE_MAX;
+
+    struct Arc {
+        size_t a, b;
+        size_t parent = NONE;
+        /* products of the region boundary without the arc itself, and of the
+         * boundary edges at a and at b */
+        V boundary = 0, left = 0, right = 0;
+        V fan = 0;
+        /* the group this arc leads: summed fans and boundary(x) - w(x), and
+         * the rest of its members as a list */
+        V num = 0, den = 1;
+        size_t next = NONE, last = NONE;
+        bool kept = true;
+        /* leftist heap links, the arc is a member of its parent's ceiling
+         * heap and owns the root of its own ceiling heap */
+        size_t heap_l = NONE, heap_r = NONE, heap_rank = 1, ceiling = NONE;
+    };
+
+    const vector<size_t> &mats;
+    size_t n, rot = 0;
+    /* weights rotated to start at the lightest vertex, and again at n + 1 */
+    vector<V> w;
+    vector<V> side_prefix;
+    vector<Arc> arcs;
+    V best = 0;
+
+    typedef unsigned __int128 u128;
+
+    /* a * b as its high and low 128 bits, from four 64 x 64 products */
+    static pair<u128, u128> mul_wide(u128 a, u128 b) {
+        const u128 LOW = UINT64_MAX;
+        u128 p00 = (a & LOW) * (b & LOW), p01 = (a & LOW) * (b >> 64);
+        u128 p10 = (a >> 64) * (b & LOW), p11 = (a >> 64) * (b >> 64);
+        u128 mid = (p00 >> 64) + (p01 & LOW) + (p10 & LOW);
+        return {p11 + (p01 >> 64) + (p10 >> 64) + (mid >> 64), (mid << 64) | (p00 & LOW)};
+    }
+
+    /* x.num / x.den >= y.num / y.den, cross-multiplied so it is exact */
+    bool heavier(const Arc &x, const Arc &y) const {
+        if constexpr (sizeof(V) <= 8) {
+            return static_cast<u128>(x.num) * y.den >= static_cast<u128>(y.num) * x.den;
+        } else {
+            return mul_wide(x.num, y.den) >= mul_wide(y.num, x.den);
+        }
+    }
+
+    V sides(size_t a, size_t b) const { return side_prefix[b] - side_prefix[a]; }
+    V side(size_t p) const { return w[p] * w[p + 1]; }
+
+    size_t merge(size_t x, size_t y) {
+        if (x == NONE) {
+            return y;
+        }
+        if (y == NONE) {
+            return x;
+        }
+        if (not heavier(arcs[x], arcs[y])) {
+            swap(x, y);
+        }
+        arcs[x].heap_r = merge(arcs[x].heap_r, y);
+        size_t l = arcs[x].heap_l, r = arcs[x].heap_r;
+        if (l == NONE or (r != NONE and arcs[l].heap_rank < arcs[r].heap_rank)) {
+            swap(arcs[x].heap_l, arcs[x].heap_r);
+        }
+        arcs[x].heap_rank = arcs[x].heap_r == NONE ? 1 : arcs[arcs[x].heap_r].heap_rank + 1;
+        return x;
+    }
+
+    /* the h-arcs in pre-order, parents before children */
+    void sweep() {
+        vector<size_t> stack{0};
+        for (size_t t = 1; t <= n; t++) {
+            while (stack.size() >= 2 and w[stack.back()] > w[t]) {
+                stack.pop_back();
+                if (stack.back() != 0) {
+                    arcs.push_back({stack.back(), t});
+                }
+            }
+            stack.push_back(t);
+        }
+        sort(arcs.begin(), arcs.end(),
+             [](const Arc &x, const Arc &y) { return x.a != y.a ? x.a < y.a : x.b > y.b; });
+        /* the whole polygon as the region of vertex 0, from 0 round to 0 */
+        arcs.insert(arcs.begin(), {0, n + 1});
+        vector<size_t> open;
+        for (size_t c = 1; c < arcs.size(); c++) {
+            while (not open.empty() and arcs[open.back()].b <= arcs[c].a) {
+                open.pop_back();
+            }
+            arcs[c].parent = open.empty() ? 0 : open.back();
+            open.push_back(c);
+        }
+    }
+
+    /* settles the region of c, its children are settled and in its heap */
+    void settle(size_t c) {
+        Arc &arc = arcs[c];
+        bool root = c == 0;
+        size_t apex = root or w[arc.a] <= w[arc.b] ? arc.a : arc.b;
+        V y = w[apex];
+        size_t heap = arc.ceiling;
+        while (heap != NONE and arcs[heap].num >= y * arcs[heap].den) {
+            Arc &d = arcs[heap];
+            for (size_t x = heap; x != NONE; x = arcs[x].next) {
+                arcs[x].kept = false;
+            }
+            arc.boundary += d.den;
+            if (d.a == arc.a) {
+                arc.left = d.left;
+            }
+            if (d.b == arc.b) {
+                arc.right = d.right;
+            }
+            heap = merge(merge(d.heap_l, d.heap_r), d.ceiling);
+        }
+        V fan_edges = arc.boundary;
+        if (root or apex == arc.a) {
+            fan_edges -= arc.left;
+        }
+        if (root or apex == arc.b) {
+            fan_edges -= arc.right;
+        }
+        arc.fan = y * fan_edges;
+        arc.num = arc.fan;
+        arc.den = arc.boundary - w[arc.a] * w[arc.b];
+        arc.last = c;
+        /* from here on left and right are those of the group */
+        while (not root and heap != NONE and heavier(arcs[heap], arc)) {
+            Arc &d = arcs[heap];
+            heap = merge(merge(d.heap_l, d.heap_r), d.ceiling);
+            arc.num += d.num;
+            arc.den += d.den;
+            if (d.a == arc.a) {
+                arc.left = d.left;
+            }
+            if (d.b == arc.b) {
+                arc.right = d.right;
+            }
+            arcs[arc.last].next = &d - arcs.data();
+            arc.last = d.last;
+        }
+        arc.ceiling = heap;
+    }
+
+    /* the fans of the kept regions, as one split per triangle */
+    SplitMap splits() {
+        SplitMap res{n};
+        /* kept arcs by first vertex, shortest first */
+        vector<vector<size_t>> from(n + 2);
+        for (size_t c = 0; c < arcs.size(); c++) {
+            if (arcs[c].kept) {
+                from[arcs[c].a].push_back(arcs[c].b);
+            }
+        }
+        for (auto &&ends : from) {
+            sort(ends.begin(), ends.end());
+        }
+        auto orig = [&](size_t p) { return (p + rot) % (n + 1); };
+        for (size_t c = 0; c < arcs.size(); c++) {
+            const Arc &arc = arcs[c];
+            if (not arc.kept) {
+                continue;
+            }
+            bool root = c == 0;
+            size_t apex = root or w[arc.a] <= w[arc.b] ? arc.a : arc.b;
+            /* walk the boundary, over the outermost kept arc where one starts */
+            for (size_t p = arc.a; p < arc.b;) {
+                auto &ends = from[p];
+                auto it = upper_bound(ends.begin(), ends.end(), arc.b);
+                if (p == arc.a and it != ends.begin() and *(it - 1) == arc.b) {
+                    it--;
+                }
+                size_t q = it == ends.begin() ? p + 1 : *(it - 1);
+                if (p != apex and q != apex and not(root and q == n + 1)) {
+                    size_t t[3] = {orig(apex), orig(p), orig(q)};
+                    sort(t, t + 3);
+                    res.set(t[0], t[2] - 1, t[1] - 1);
+                }
+                p = q;
+            }
+        }
+        return res;
+    }
+
+  public:
+    explicit HuShing(const vector<size_t> &mats_) : mats(mats_), n(mats_.size() - 1) {}
+
+    /* the optimal cost and its parenthesisation */
+    pair<V, SplitMap> run() {
+        if (n < 2) {
+            SplitMap res{n};
+            return {0, std::move(res)};
+        }
+        rot = min_element(mats.begin(), mats.end()) - mats.begin();
+        for (size_t p = 0; p <= n + 1; p++) {
+            w.push_back(mats[(p + rot) % (n + 1)]);
+        }
+        side_prefix.push_back(0);
+        for (size_t p = 0; p <= n; p++) {
+            side_prefix.push_back(side_prefix.back() + side(p));
+        }
+        sweep();
+        for (auto &&arc : arcs) {
+            arc.boundary = sides(arc.a, arc.b);
+            arc.left = side(arc.a);
+            arc.right = side(arc.b - 1);
+        }
+        /* reversed pre-order settles children before parents */
+        for (size_t c = arcs.size(); c-- > 0;) {
+            settle(c);
+            size_t up = arcs[c].parent;
+            if (up == NONE) {
+                continue;
+            }
+            Arc &arc = arcs[c], &par = arcs[up];
+            par.boundary += w[arc.a] * w[arc.b] - sides(arc.a, arc.b);
+            if (arc.a == par.a) {
+                par.left = w[arc.a] * w[arc.b];
+            }
+            if (arc.b == par.b) {
+                par.right = w[arc.a] * w[arc.b];
+            }
+            par.ceiling = merge(par.ceiling, c);
+        }
+        for (auto &&arc : arcs) {
+            if (arc.kept) {
+                best += arc.fan;
+            }
+        }
+        return {best, splits()};
+    }
+};
@@ -5,48 +5,22 @@
 #include <iostream>
 #include <limits>
 #include <ostream>
+#include <random>
 #include <ranges>
 #include <vector>
 #include <chrono>
-#include "table.h"
+#include "chain_dp.h"
+#include "executor.h"
+#include "hu_shing.h"
+#include "../interval_dp.h"
+#include "../io.h"
+#include "../table.h"
 
 using namespace std;
 
-pair<Table<long long>, Table<size_t>> mat_mul_dp(const vector<size_t> &mats) {
-    auto mat_num = mats.size() - 1;
-    Table<long long> table(mat_num, mat_num);
-    Table<size_t> choice(mat_num, mat_num);
-
-    // [i, i]
-    for (size_t i = 0; i < mat_num; i++) {
-        table.at(i, i) = 0;
-    }
-
-    // [i, j]
-    for (size_t len = 1; len < mat_num; len++) {
-        for (size_t i = 0; i < mat_num - len; i++) {
-            size_t j = i + len;
-
-            // [i, k], [k + 1, j]
-            size_t min_cost = std::numeric_limits<long long>::max();
-            size_t min_cost_k;
-            for (size_t k = i; k < j; k++) {
-                size_t cost = table.at(i, k) + table.at(k + 1, j) +
-                              mats[i] * mats[k + 1] * mats[j + 1];
-                if (cost < min_cost) {
-                    min_cost = cost;
-                    min_cost_k = k;
-                }
-            }
-            table.at(i, j) = min_cost;
-            choice.at(i, j) = min_cost_k;
-        }
-    }
-    return {table, choice};
-}
-
+/* T is a square Table or a Triangle */
 template<typename T>
-void print_triangle(ostream &os, Table<T> &t) {
+void print_triangle(Writer &os, T &t) {
     for (auto i : views::iota(0, static_cast<int>(t.get_width()))) {
         for (auto j :
                 views::iota(i, static_cast<int>(t.get_width())) | views::reverse) {
@@ -58,47 +32,136 @@ void print_triangle(ostream &os, Table<T> &t) {
     }
 }
 
-void pretty_print_solution(ostream &os, Table<size_t> &solv, size_t i = 0,
-                           size_t j = numeric_limits<size_t>::max()) {
-    if (j == numeric_limits<size_t>::max()) {
-        j = solv.get_width() - 1;
+/* T is a choice Table, a Triangle or a SplitMap. the tree of a long chain
+ * can be as deep as the chain, so it is walked with an explicit stack */
+template <typename T>
+void pretty_print_solution(Writer &os, T &solv) {
+    /* an interval [i, j], or a closing character when i is NONE */
+    const size_t NONE = numeric_limits<size_t>::max();
+    vector<pair<size_t, size_t>> todo{{0, solv.get_width() - 1}};
+    while (not todo.empty()) {
+        auto [i, j] = todo.back();
+        todo.pop_back();
+        if (i == NONE) {
+            os << static_cast<char>(j);
+        } else if (i == j) {
+            os << i;
+        } else {
+            os << '(';
+            size_t k = solv.at(i, j);
+            todo.push_back({NONE, ')'});
+            todo.push_back({k + 1, j});
+            todo.push_back({NONE, ','});
+            todo.push_back({i, k});
+        }
     }
-    if (i == j) {
-        os << i;
-        return;
+}
+
+/* multiplies random matrices along the plan, one report line per chain */
+template <typename Plan> void run_plan(ostream &os, const vector<size_t> &mats, const Plan &plan) {
+    mt19937_64 gen{mats.size()};
+    uniform_real_distribution<double> dist{-1, 1};
+    vector<vector<double>> leaves(mats.size() - 1);
+    vector<const double *> ptrs;
+    for (size_t i = 0; i + 1 < mats.size(); i++) {
+        leaves[i].resize(mats[i] * mats[i + 1]);
+        for (auto &&v : leaves[i]) {
+            v = dist(gen);
+        }
+        ptrs.push_back(leaves[i].data());
     }
-    os << '(';
-    auto k = solv.at(i, j);
-    pretty_print_solution(os, solv, i, k);
-    os << ',';
-    pretty_print_solution(os, solv, k + 1, j);
-    os << ')';
+    ChainExecutor exec{mats, plan, ptrs};
+    auto t1 = chrono::high_resolution_clock::now();
+    exec.run();
+    auto t2 = chrono::high_resolution_clock::now();
+    auto ns = chrono::duration_cast<chrono::nanoseconds>(t2 - t1).count();
+    /* a multiply and an add per predicted scalar multiply */
+    os << mats.size() - 1 << " matrices, " << exec.multiplies() << " multiplies predicted, "
+       << exec.arena_bytes() << " arena bytes, " << ns << "ns, " << (ns > 0 ? 2.0 * exec.multiplies() / ns : 0)
+       << " GFLOP/s\n";
 }
 
-int main() {
-    ifstream is{"../input/2_1_input.txt"};
-    ofstream os("../output/result.txt");
+/* pass --table to dump both tables to stdout, it is off by default since
+ * the dump costs far more than the dp. --generic solves with the interval
+ * dp engine on packed triangles instead, same results. --hu-shing finds the
+ * order in o(n log n) without any table, for chains of any length.
+ * --execute also multiplies random matrices of the chain along the plan and
+ * puts predicted multiplies against measured speed in execute.txt. parse,
+ * solve and emit totals go to stderr */
+int main(int argc, char *argv[]) {
+    bool dump = false, generic = false, hu_shing = false, execute = false;
+    for (auto arg : views::counted(argv + 1, argc - 1)) {
+        dump |= string_view{arg} == "--table";
+        generic |= string_view{arg} == "--generic";
+        hu_shing |= string_view{arg} == "--hu-shing";
+        execute |= string_view{arg} == "--execute";
+    }
+    typedef chrono::high_resolution_clock Clock;
+    Clock::duration parse{}, solve{}, emit{};
+    auto t0 = Clock::now();
+    MappedFile in{"../input/2_1_input.txt"};
+    Scanner is{in.view()};
+    ofstream file("../output/result.txt");
+    Writer os{file};
     ofstream os_t("../output/time.txt");
-    while (not(is.peek(), is.eof())) {
-        int cnt;
-        is >> cnt;
+    Writer out{cout};
+    ofstream os_x;
+    if (execute) {
+        os_x.open("../output/execute.txt");
+    }
+    while (not is.done()) {
+        auto cnt = is.number<size_t>();
         vector<size_t> mats;
-        for (auto _ : views::iota(0, cnt + 1)) {
-            size_t mat;
-            is >> mat;
-            mats.push_back(mat);
+        for (size_t i = 0; i <= cnt; i++) {
+            mats.push_back(is.number<size_t>());
         }
-        typedef chrono::high_resolution_clock Clock;
         auto t1 = Clock::now();
-        auto [table, choice] = mat_mul_dp(mats);
-        auto t2 = Clock::now();
-        os_t << t2 - t1 << '\n';
-        print_triangle(cout, table);
-        cout << '\n';
-        print_triangle(cout, choice);
-        cout << '\n';
-        os << table.at(0, choice.get_width() - 1) << '\n';
-        pretty_print_solution(os, choice);
-        os << '\n';
+        parse += t1 - t0;
+        /* dense tables and packed triangles print alike, hu-shing has none */
+        auto emit_case = [&](auto best, auto &choice, auto &&print_tables) {
+            auto t2 = Clock::now();
+            solve += t2 - t1;
+            os_t << t2 - t1 << '\n';
+            if (dump) {
+                print_tables();
+            }
+            os << best << '\n';
+            pretty_print_solution(os, choice);
+            os << '\n';
+            t0 = Clock::now();
+            emit += t0 - t2;
+            if (execute) {
+                run_plan(os_x, mats, choice);
+                t0 = Clock::now();
+            }
+        };
+        with_cost_type(mats, [&](auto cost) {
+            with_cell_type(cnt, [&](auto cell) {
+                typedef decltype(cost) V;
+                typedef decltype(cell) C;
+                auto tables = [&](auto &table, auto &choice) {
+                    return [&] {
+                        print_triangle(out, table);
+                        out << '\n';
+                        print_triangle(out, choice);
+                        out << '\n';
+                    };
+                };
+                if (hu_shing) {
+                    auto [best, splits] = HuShing<V>{mats}.run();
+                    return emit_case(best, splits, [] {});
+                }
+                if (generic) {
+                    IntervalDp<V, decltype(chain_cost<V>(mats)), plus<V>, C> dp{cnt, chain_cost<V>(mats)};
+                    dp.run();
+                    return emit_case(dp.values().at(0, cnt - 1), dp.choices(), tables(dp.values(), dp.choices()));
+                }
+                auto [table, choice] = mat_mul_dp<V, C>(mats);
+                emit_case(table.at(0, cnt - 1), choice, tables(table, choice));
+            });
+        });
     }
-}
\ No newline at end of file
+    os.flush();
+    out.flush();
+    cerr << "parse " << parse << ", solve " << solve << ", emit " << emit << '\n';
+}
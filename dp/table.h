@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <sys/mman.h>
+
+using namespace std;
+
+/* how (x, y) maps to memory. ROW_MAJOR keeps x contiguous inside a row,
+ * TILED stores TILE x TILE blocks one after another, MORTON interleaves the
+ * bits of x and y so any aligned power of two square is contiguous */
+enum class Layout { ROW_MAJOR, TILED, MORTON };
+
+/* zero initialised width x height table of dp cells, every row starts on a
+ * cache line. large tables come straight from mmap, already zeroed, and can
+ * ask for transparent huge pages */
+template <typename T, Layout L = Layout::ROW_MAJOR> class Table {
+  public:
+    const static size_t LINE = 64;
+    const static size_t TILE = 16;
+
+  private:
+    /* from this size on the kernel's zero pages beat new + memset */
+    const static size_t MMAP_MIN = 1 << 21;
+    T *table = nullptr;
+    size_t width = 0, height = 0, pitch = 0, bytes = 0;
+    bool mapped = false;
+
+    static size_t round_up(size_t n, size_t m) { return (n + m - 1) / m * m; }
+
+    /* bit i of v moves to bit 2i, v < 2^32 */
+    static size_t spread(size_t v) {
+        v &= 0xffffffffu;
+        v = (v | v << 16) & 0x0000ffff0000ffffu;
+        v = (v | v << 8) & 0x00ff00ff00ff00ffu;
+        v = (v | v << 4) & 0x0f0f0f0f0f0f0f0fu;
+        v = (v | v << 2) & 0x3333333333333333u;
+        v = (v | v << 1) & 0x5555555555555555u;
+        return v;
+    }
+
+    size_t index(size_t x, size_t y) const {
+        if constexpr (L == Layout::ROW_MAJOR) {
+            return x + y * pitch;
+        } else if constexpr (L == Layout::TILED) {
+            size_t tile = (y / TILE) * (pitch / TILE) + x / TILE;
+            return tile * TILE * TILE + (y % TILE) * TILE + x % TILE;
+        } else {
+            return spread(x) | spread(y) << 1;
+        }
+    }
+
+    void release() {
+        if (not table) {
+            return;
+        }
+        if (mapped) {
+            munmap(table, bytes);
+        } else {
+            operator delete(table, align_val_t{LINE});
+        }
+        table = nullptr;
+    }
+
+  public:
+    Table(size_t width_, size_t height_, bool huge_pages = false) : width{width_}, height(height_) {
+        size_t cells;
+        if constexpr (L == Layout::ROW_MAJOR) {
+            pitch = LINE % sizeof(T) == 0 ? round_up(width, LINE / sizeof(T)) : width;
+            cells = pitch * height;
+        } else if constexpr (L == Layout::TILED) {
+            pitch = round_up(width, TILE);
+            cells = pitch * round_up(height, TILE);
+        } else {
+            pitch = bit_ceil(max(width, height));
+            cells = pitch * pitch;
+        }
+        bytes = round_up(max<size_t>(cells, 1) * sizeof(T), LINE);
+        if (huge_pages or bytes >= MMAP_MIN) {
+            void *p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) {
+                throw bad_alloc{};
+            }
+            if (huge_pages) {
+                /* only a hint, a kernel without thp keeps small pages */
+                madvise(p, bytes, MADV_HUGEPAGE);
+            }
+            table = static_cast<T *>(p);
+            mapped = true;
+        } else {
+            table = static_cast<T *>(operator new(bytes, align_val_t{LINE}));
+            memset(table, 0, bytes);
+        }
+    }
+    Table(const Table &) = delete;
+    Table(Table &&t) noexcept { *this = std::move(t); }
+    Table &operator=(Table &&t) noexcept {
+        if (this != &t) {
+            release();
+            swap(table, t.table);
+            width = t.width;
+            height = t.height;
+            pitch = t.pitch;
+            bytes = t.bytes;
+            mapped = t.mapped;
+            t.mapped = false;
+        }
+        return *this;
+    }
+    ~Table() { release(); }
+
+    T &at(size_t x, size_t y) {
+        assert(x < width and y < height);
+        return table[index(x, y)];
+    }
+    const T &at(size_t x, size_t y) const {
+        assert(x < width and y < height);
+        return table[index(x, y)];
+    }
+
+    /* first cell of row y, the row holds width cells */
+    T *row(size_t y)
+        requires(L == Layout::ROW_MAJOR)
+    {
+        assert(y < height);
+        return &table[y * pitch];
+    }
+
+    size_t get_width() const { return width; }
+    size_t get_height() const { return height; }
+    /* cells from one row to the next */
+    size_t get_pitch() const { return pitch; }
+};
+
+/* upper triangle i <= j of an n x n table, packed diagonal by diagonal:
+ * all cells with j - i == len are contiguous and the diagonals follow each
+ * other, so the writes of an interval dp that sweeps by length walk memory
+ * in order, in half the cells of a square Table. its reads of a row or a
+ * column of the triangle are strided, see MirroredTriangle */
+template <typename T> class Triangle {
+    vector<T> cells;
+    size_t n = 0;
+
+    /* cells on the diagonals before len */
+    size_t offset(size_t len) const { return len * n - len * (len - 1) / 2; }
+
+  public:
+    explicit Triangle(size_t n_) : cells(n_ * (n_ + 1) / 2), n(n_) {}
+
+    T &at(size_t i, size_t j) {
+        assert(i <= j and j < n);
+        return cells[offset(j - i) + i];
+    }
+    const T &at(size_t i, size_t j) const {
+        assert(i <= j and j < n);
+        return cells[offset(j - i) + i];
+    }
+
+    /* first cell (0, len) of a diagonal, the diagonal holds n - len cells */
+    T *diagonal(size_t len) {
+        assert(len < n);
+        return &cells[offset(len)];
+    }
+
+    size_t get_width() const { return n; }
+};
+
+/* upper triangle i <= j of an n x n table kept twice, packed by rows and
+ * by columns, so f(i, i..n-1) and f(0..j, j) are each contiguous. the k
+ * loop of an interval dp reads row i and column j and walks both in order.
+ * as many cells as a square Table, every write goes to both copies */
+template <typename T> class MirroredTriangle {
+    vector<T> by_row, by_col;
+    size_t n = 0;
+
+    /* cells in the rows before i, and in the columns before j */
+    size_t row_offset(size_t i) const { return i * n - i * (i - 1) / 2; }
+    size_t col_offset(size_t j) const { return j * (j + 1) / 2; }
+
+  public:
+    explicit MirroredTriangle(size_t n_) : by_row(n_ * (n_ + 1) / 2), by_col(n_ * (n_ + 1) / 2), n(n_) {}
+
+    const T &at(size_t i, size_t j) const {
+        assert(i <= j and j < n);
+        return by_row[row_offset(i) + j - i];
+    }
+    void set(size_t i, size_t j, const T &v) {
+        assert(i <= j and j < n);
+        by_row[row_offset(i) + j - i] = v;
+        by_col[col_offset(j) + i] = v;
+    }
+
+    /* row(i)[k] is (i, k) for k in [i, n) */
+    const T *row(size_t i) const {
+        assert(i < n);
+        return &by_row[row_offset(i)] - i;
+    }
+    /* col(j)[k] is (k, j) for k in [0, j] */
+    const T *col(size_t j) const {
+        assert(j < n);
+        return &by_col[col_offset(j)];
+    }
+
+    size_t get_width() const { return n; }
+};
+
+/* call f with a value of the narrowest unsigned cell type that holds
+ * max_value, so a table that can is two or four times denser than size_t */
+template <typename F> decltype(auto) with_cell_type(size_t max_value, F &&f) {
+    if (max_value <= UINT16_MAX) {
+        return f(uint16_t{});
+    }
+    if (max_value <= UINT32_MAX) {
+        return f(uint32_t{});
+    }
+    return f(size_t{});
+}
@@ -0,0 +1,618 @@
+#include "interval_dp.h"
+#include "io.h"
+#include "lcs/batch_lcs.h"
+#include "lcs/bit_lcs.h"
+#include "lcs/hirschberg.h"
+#include "lcs/lcs_dp.h"
+#include "lcs/wavefront.h"
+#include "matrix_mul/chain_dp.h"
+#include "matrix_mul/executor.h"
+#include "matrix_mul/hu_shing.h"
+#include "table.h"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+using namespace std;
+
+template <typename T, Layout L> void layout_test(size_t width, size_t height, bool huge_pages) {
+    Table<T, L> t{width, height, huge_pages};
+    assert(t.get_width() == width and t.get_height() == height);
+
+    // zero initialised
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            assert(t.at(x, y) == 0);
+        }
+    }
+
+    // every cell is its own
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            t.at(x, y) = static_cast<T>(x * 31 + y * 17 + 1);
+        }
+    }
+    for (size_t y = 0; y < height; y++) {
+        for (size_t x = 0; x < width; x++) {
+            assert(t.at(x, y) == static_cast<T>(x * 31 + y * 17 + 1));
+        }
+    }
+
+    // move keeps the cells
+    Table<T, L> moved{std::move(t)};
+    assert(moved.get_width() == width and moved.get_height() == height);
+    assert(moved.at(width - 1, height - 1) == static_cast<T>((width - 1) * 31 + (height - 1) * 17 + 1));
+}
+
+template <typename T> void alignment_test(size_t width, size_t height) {
+    Table<T> t{width, height};
+    for (size_t y = 0; y < height; y++) {
+        assert(reinterpret_cast<uintptr_t>(t.row(y)) % Table<T>::LINE == 0);
+        assert(t.row(y) == &t.at(0, y));
+    }
+    assert(t.get_pitch() >= width);
+}
+
+template <typename T> void all_layouts_test(size_t width, size_t height, bool huge_pages = false) {
+    cout << "table " << width << 'x' << height << " of " << sizeof(T) << "-byte cells"
+         << (huge_pages ? ", huge pages\n" : "\n");
+    layout_test<T, Layout::ROW_MAJOR>(width, height, huge_pages);
+    layout_test<T, Layout::TILED>(width, height, huge_pages);
+    layout_test<T, Layout::MORTON>(width, height, huge_pages);
+    alignment_test<T>(width, height);
+}
+
+void task_group_test() {
+    ThreadPool pool{3};
+    atomic<size_t> ran{0};
+    TaskGroup tg{pool};
+    for (size_t i = 0; i < 100; i++) {
+        tg.run([&, i] {
+            ran++;
+            if (i % 10 == 3) {
+                throw runtime_error{"task " + to_string(i)};
+            }
+        });
+    }
+    bool caught = false;
+    try {
+        tg.wait();
+    } catch (const runtime_error &e) {
+        caught = string_view{e.what()}.starts_with("task ");
+    }
+    // every task ran, one error came back, and the group is reusable
+    assert(caught and ran == 100);
+    tg.run([&] { ran++; });
+    tg.wait();
+    assert(ran == 101);
+}
+
+void cell_type_test() {
+    auto size_of = [](auto cell) { return sizeof(cell); };
+    assert(with_cell_type(0, size_of) == 2);
+    assert(with_cell_type(UINT16_MAX, size_of) == 2);
+    assert(with_cell_type(UINT16_MAX + 1, size_of) == 4);
+    assert(with_cell_type(UINT32_MAX, size_of) == 4);
+    assert(with_cell_type(size_t{UINT32_MAX} + 1, size_of) == 8);
+}
+
+void io_test() {
+    string path = "io_test_input.txt";
+    {
+        ofstream f{path};
+        f << "3 abc  de\n\t17\r\n0 x"; // no trailing newline, like the inputs
+    }
+    {
+        MappedFile in{path};
+        Scanner is{in.view()};
+        assert(not is.done());
+        assert(is.number<size_t>() == 3);
+        assert(is.word() == "abc" and is.word() == "de");
+        assert(is.number<uint32_t>() == 17 and is.number<size_t>() == 0);
+        assert(is.word() == "x");
+        assert(is.done());
+    }
+    {
+        ofstream f{path};
+    }
+    {
+        MappedFile in{path};
+        assert(Scanner{in.view()}.done());
+    }
+    remove(path.c_str());
+
+    ostringstream ss;
+    {
+        Writer w{ss};
+        w << uint16_t{65535} << ' ' << -12 << ' ' << size_t{1} << 'x' << "yz" << '\n';
+        // more than one buffer
+        for (int i = 0; i < 100000; i++) {
+            w << i % 10;
+        }
+    }
+    string out = ss.str();
+    assert(out.substr(0, 16) == "65535 -12 1xyz\n0");
+    assert(out.length() == 15 + 100000 and out.back() == '9');
+}
+
+void triangle_test(size_t n) {
+    Triangle<uint32_t> t{n};
+    assert(t.get_width() == n);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i; j < n; j++) {
+            assert(t.at(i, j) == 0);
+            t.at(i, j) = static_cast<uint32_t>(i * 1000 + j);
+        }
+    }
+    // diagonals are contiguous and follow each other
+    uint32_t *prev_end = nullptr;
+    for (size_t len = 0; len < n; len++) {
+        uint32_t *d = t.diagonal(len);
+        assert(prev_end == nullptr or d == prev_end);
+        for (size_t i = 0; i + len < n; i++) {
+            assert(&d[i] == &t.at(i, i + len) and d[i] == i * 1000 + i + len);
+        }
+        prev_end = d + n - len;
+    }
+}
+
+void mirrored_triangle_test(size_t n) {
+    MirroredTriangle<uint32_t> t{n};
+    assert(t.get_width() == n);
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i; j < n; j++) {
+            assert(t.at(i, j) == 0);
+            t.set(i, j, static_cast<uint32_t>(i * 1000 + j));
+        }
+    }
+    // every row and every column reads back in order from one pointer
+    for (size_t i = 0; i < n; i++) {
+        for (size_t k = i; k < n; k++) {
+            assert(t.row(i)[k] == i * 1000 + k and t.at(i, k) == t.row(i)[k]);
+        }
+        for (size_t k = 0; k <= i; k++) {
+            assert(t.col(i)[k] == k * 1000 + i);
+        }
+    }
+}
+
+/* f(i, j) by plain recursion over every split */
+template <typename V> V interval_brute(size_t i, size_t j, const function<V(size_t, size_t, size_t)> &cost) {
+    if (i == j) {
+        return 0;
+    }
+    V best = 0;
+    for (size_t k = i; k < j; k++) {
+        V c = interval_brute(i, k, cost) + interval_brute(k + 1, j, cost) + cost(i, k, j);
+        if (k == i or c < best) {
+            best = c;
+        }
+    }
+    return best;
+}
+
+/* the cell of every interval against the recursion, and the split against
+ * its definition */
+template <typename Dp, typename V>
+void interval_check(Dp &dp, size_t n, const function<V(size_t, size_t, size_t)> &cost) {
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 1; j < n and j < i + 9; j++) {
+            assert(dp.values().at(i, j) == interval_brute(i, j, cost));
+            size_t k = dp.choices().at(i, j);
+            assert(i <= k and k < j);
+            assert(dp.values().at(i, k) + dp.values().at(k + 1, j) + cost(i, k, j) == dp.values().at(i, j));
+        }
+    }
+}
+
+void interval_test() {
+    mt19937 gen{7};
+    ThreadPool pool{3};
+
+    // matrix chain, the cost depends on the split so there is no shortcut
+    for (size_t n : {1, 2, 5, 8, 300}) {
+        vector<size_t> dims(n + 1);
+        for (auto &d : dims) {
+            d = 1 + gen() % 50;
+        }
+        IntervalDp<uint64_t, decltype(chain_cost<uint64_t>(dims))> dp{n, chain_cost<uint64_t>(dims), {}, pool};
+        dp.run();
+        assert(not dp.used_knuth());
+        interval_check<decltype(dp), uint64_t>(dp, n, chain_cost<uint64_t>(dims));
+        IntervalDp<uint64_t, decltype(chain_cost<uint64_t>(dims))> moved{n, chain_cost<uint64_t>(vector{dims}), {}, pool};
+        moved.run();
+        assert(moved.values().at(0, n - 1) == dp.values().at(0, n - 1));
+    }
+
+    // optimal bst, knuth-yao applies and must not change a value or a split
+    for (size_t keys : {1, 4, 9, 400}) {
+        vector<uint64_t> p(keys), q(keys + 1);
+        for (auto &w : p) {
+            w = gen() % 100;
+        }
+        for (auto &w : q) {
+            w = gen() % 100;
+        }
+        auto cost = bst_cost(p, q);
+        IntervalDp<uint64_t, decltype(cost)> dp{keys + 1, cost, {}, pool};
+        dp.run();
+        assert(dp.used_knuth());
+        interval_check<decltype(dp), uint64_t>(dp, keys + 1, [&](size_t i, size_t, size_t j) { return cost(i, j); });
+        // the full search, forced by a cost that hides its split independence
+        auto split_cost = [&](size_t i, size_t, size_t j) { return cost(i, j); };
+        IntervalDp<uint64_t, decltype(split_cost)> full{keys + 1, split_cost, {}, pool};
+        full.run();
+        assert(not full.used_knuth());
+        for (size_t i = 0; i <= keys; i++) {
+            for (size_t j = i + 1; j <= keys; j++) {
+                assert(dp.values().at(i, j) == full.values().at(i, j));
+                assert(dp.choices().at(i, j) == full.choices().at(i, j));
+            }
+        }
+        // the cost keeps what it needs when built from temporaries
+        IntervalDp<uint64_t, decltype(cost)> moved{keys + 1, bst_cost(vector{p}, vector{q}), {}, pool};
+        moved.run();
+        assert(moved.values().at(0, keys) == dp.values().at(0, keys));
+    }
+
+    // a split independent cost that breaks the quadrangle inequality
+    auto bumpy = [](size_t i, size_t j) -> uint64_t { return (i * 7 + j * 13) % 10; };
+    IntervalDp<uint64_t, decltype(bumpy)> bumpy_dp{40, bumpy, {}, pool};
+    bumpy_dp.run();
+    assert(not bumpy_dp.used_knuth());
+    interval_check<decltype(bumpy_dp), uint64_t>(bumpy_dp, 40, [&](size_t i, size_t, size_t j) { return bumpy(i, j); });
+
+    // polygon triangulation, perimeter weight of every triangle
+    vector<pair<long long, long long>> pts;
+    for (size_t v = 0; v < 12; v++) {
+        pts.push_back({static_cast<long long>(gen() % 1000), static_cast<long long>(gen() % 1000)});
+    }
+    auto dist = [&](size_t a, size_t b) {
+        return llabs(pts[a].first - pts[b].first) + llabs(pts[a].second - pts[b].second);
+    };
+    auto weight = [&](size_t a, size_t b, size_t c) { return dist(a, b) + dist(b, c) + dist(c, a); };
+    auto tri = polygon_cost<long long>(weight);
+    IntervalDp<long long, decltype(tri)> poly{pts.size() - 1, tri, {}, pool};
+    poly.run();
+    interval_check<decltype(poly), long long>(poly, pts.size() - 1, tri);
+}
+
+/* the tiled chain dp against the generic engine, every cell and split, for
+ * chains inside one tile, across tile edges and past the parallel cutoff.
+ * dims up to 2^22 need 128 bit costs */
+void chain_dp_test() {
+    mt19937 gen{17};
+    ThreadPool pool{3};
+    size_t wide = 0;
+    for (size_t n : {1, 2, 5, 63, 64, 65, 130, 300}) {
+        for (size_t max_dim : {size_t{4}, size_t{1000}, size_t{1} << 22}) {
+            vector<size_t> dims(n + 1);
+            for (auto &d : dims) {
+                d = 1 + gen() % max_dim;
+            }
+            with_cost_type(dims, [&](auto cost) {
+                typedef decltype(cost) V;
+                wide += is_same_v<V, unsigned __int128>;
+                auto [table, choice] = mat_mul_dp<V, uint32_t>(dims, pool);
+                IntervalDp<V, decltype(chain_cost<V>(dims))> dp{n, chain_cost<V>(dims), {}, pool};
+                dp.run();
+                for (size_t i = 0; i < n; i++) {
+                    for (size_t j = i + 1; j < n; j++) {
+                        assert(table.at(i, j) == dp.values().at(i, j) and table.at(j, i) == table.at(i, j));
+                        assert(choice.at(i, j) == dp.choices().at(i, j));
+                    }
+                }
+            });
+        }
+    }
+    assert(wide > 0);
+}
+
+string random_string(mt19937 &gen, size_t len, size_t alphabet) {
+    string s(len, 'a');
+    for (auto &c : s) {
+        c = 'a' + gen() % alphabet;
+    }
+    return s;
+}
+
+/* the subsequence pretty_print_solution traces from the full table */
+string traced_lcs(const string &x, const string &y) {
+    auto t = lcs_dp<uint32_t>(x, y);
+    stringstream ss;
+    {
+        Writer os{ss};
+        pretty_print_solution(os, t, x, y);
+    }
+    return ss.str();
+}
+
+void bit_lcs_test() {
+    mt19937 gen{31};
+    // one word, one word and a bit, two words
+    const size_t lens[] = {0, 1, 63, 64, 65, 128, 200};
+    for (size_t n : lens) {
+        for (size_t m : lens) {
+            for (size_t alphabet : {2, 4, 26}) {
+                auto x = random_string(gen, n, alphabet), y = random_string(gen, m, alphabet);
+                assert(lcs_length(x, y) == lcs_dp<uint16_t>(x, y).at(m, n));
+                // characters the other string never has
+                string z = x;
+                for (size_t i = 0; i < z.length(); i += 3) {
+                    z[i] = 'A' + gen() % 26;
+                }
+                assert(lcs_length(z, y) == lcs_dp<uint16_t>(z, y).at(m, n));
+                assert(lcs_length(y, z) == lcs_dp<uint16_t>(y, z).at(n, m));
+            }
+        }
+    }
+}
+
+void hirschberg_test() {
+    mt19937 gen{17};
+    ThreadPool pool{3};
+    for (size_t alphabet : {2, 4, 26}) {
+        for (auto [n, m] : {pair{0, 0}, {0, 5}, {5, 0}, {1, 1}, {7, 13}, {100, 100}, {300, 700}, {1000, 90}}) {
+            auto x = random_string(gen, n, alphabet), y = random_string(gen, m, alphabet);
+            assert(lcs_hirschberg(x, y, pool) == traced_lcs(x, y));
+        }
+    }
+    // past BASE_AREA, and halves past PAR_AREA so they split over the pool
+    for (auto [n, m, alphabet] : {tuple{600, 500, 4}, {4500, 4600, 2}, {4600, 4500, 26}}) {
+        auto x = random_string(gen, n, alphabet), y = random_string(gen, m, alphabet);
+        assert(lcs_hirschberg(x, y, pool) == traced_lcs(x, y));
+    }
+}
+
+template <typename T> void wavefront_test(ThreadPool &pool) {
+    mt19937 gen{23};
+    // inside one tile, on and across tile edges, and |x| != |y|
+    for (auto [n, m] : {pair{0, 0}, {0, 9}, {9, 0}, {1, 1}, {50, 70}, {127, 127}, {128, 128}, {129, 129},
+                        {127, 129}, {300, 129}, {129, 300}, {257, 520}, {600, 40}}) {
+        auto x = random_string(gen, n, 2 + gen() % 25), y = random_string(gen, m, 2 + gen() % 25);
+        auto want = lcs_dp<T>(x, y);
+        for (bool scalar : {false, true}) {
+            Wavefront<T>::scalar_only = scalar;
+            auto t = lcs_wavefront<T>(x, y, pool);
+            for (size_t i = 0; i <= x.length(); i++) {
+                for (size_t j = 0; j <= y.length(); j++) {
+                    assert(t.at(j, i) == want.at(j, i));
+                }
+            }
+        }
+        Wavefront<T>::scalar_only = false;
+    }
+}
+
+void batch_lcs_test(ThreadPool &pool) {
+    mt19937 gen{29};
+    // 48 is SHORT_MAX, the longest pair a lane takes
+    const size_t lens[] = {0, 1, 5, 17, 47, 48, 49, 64};
+    // partial batches, one full batch, and enough for several tasks
+    for (size_t cnt : {1, 2, 15, 16, 17, 40, 3000}) {
+        vector<pair<string, string>> pairs;
+        for (size_t p = 0; p < cnt; p++) {
+            size_t alphabet = 2 + gen() % 25;
+            pairs.emplace_back(random_string(gen, lens[gen() % size(lens)], alphabet),
+                               random_string(gen, lens[gen() % size(lens)], alphabet));
+        }
+        for (bool scalar : {false, true}) {
+            BatchLcs::scalar_only = scalar;
+            auto res = BatchLcs{pool}.run(pairs);
+            assert(res.size() == cnt);
+            for (size_t p = 0; p < cnt; p++) {
+                auto &[x, y] = pairs[p];
+                assert(res[p] == lcs_dp<uint16_t>(x, y).at(y.length(), x.length()));
+            }
+        }
+        BatchLcs::scalar_only = false;
+    }
+}
+
+/* cost of the parenthesisation splits gives to [i, j] */
+uint64_t chain_cost_of(const SplitMap &splits, const vector<size_t> &dims, size_t i, size_t j) {
+    if (i == j) {
+        return 0;
+    }
+    size_t k = splits.at(i, j);
+    assert(i <= k and k < j);
+    return chain_cost_of(splits, dims, i, k) + chain_cost_of(splits, dims, k + 1, j) + dims[i] * dims[k + 1] * dims[j + 1];
+}
+
+void hu_shing_test() {
+    mt19937 gen{11};
+    for (size_t t = 0; t < 1000; t++) {
+        size_t n = 1 + gen() % (t % 10 == 0 ? 200 : 12);
+        // few distinct dims make many ties
+        size_t max_dim = t % 3 == 0 ? 4 : 1000;
+        vector<size_t> dims(n + 1);
+        for (auto &d : dims) {
+            d = 1 + gen() % max_dim;
+        }
+        IntervalDp<uint64_t, decltype(chain_cost<uint64_t>(dims))> dp{n, chain_cost<uint64_t>(dims)};
+        dp.run();
+        auto [best, splits] = HuShing<uint64_t>{dims}.run();
+        assert(best == dp.values().at(0, n - 1));
+        assert(n == 1 or chain_cost_of(splits, dims, 0, n - 1) == best);
+    }
+
+    // dims near 2^22 need 128-bit costs, near 2^40 the ratios need 256-bit
+    // cross products. close dims leave ratios that differ in low bits only
+    typedef unsigned __int128 u128;
+    for (size_t t = 0; t < 300; t++) {
+        bool huge = t % 2;
+        size_t n = 1 + gen() % (huge ? 12 : t % 10 == 0 ? 200 : 12);
+        size_t base = huge ? size_t{1} << 40 : size_t{1} << 22;
+        vector<size_t> dims(n + 1);
+        for (auto &d : dims) {
+            d = base - gen() % (t % 3 == 0 ? 4 : 1 << 12);
+        }
+        assert(with_cost_type(dims, [](auto v) { return sizeof(v); }) == 16);
+        IntervalDp<u128, decltype(chain_cost<u128>(dims))> dp{n, chain_cost<u128>(dims)};
+        dp.run();
+        auto [best, splits] = HuShing<u128>{dims}.run();
+        assert(best == dp.values().at(0, n - 1));
+    }
+}
+
+void naive_multiply(const double *a, const double *b, double *c, size_t m, size_t k, size_t n) {
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            double sum = 0;
+            for (size_t l = 0; l < k; l++) {
+                sum += a[i * k + l] * b[l * n + j];
+            }
+            c[i * n + j] = sum;
+        }
+    }
+}
+
+void gemm_test() {
+    mt19937 gen{13};
+    uniform_real_distribution<double> dist{-1, 1};
+    ThreadPool pool{3};
+    // ragged edges in every dimension, sizes past one block, and an empty k
+    for (auto [m, k, n] : {tuple{1, 1, 1}, {7, 5, 3}, {13, 300, 17}, {100, 97, 250}, {301, 260, 70}, {9, 0, 11}}) {
+        vector<double> a(m * k), b(k * n), want(m * n);
+        for (auto &v : a) {
+            v = dist(gen);
+        }
+        for (auto &v : b) {
+            v = dist(gen);
+        }
+        naive_multiply(a.data(), b.data(), want.data(), m, k, n);
+        for (bool scalar : {false, true}) {
+            Gemm::scalar_only = scalar;
+            vector<double> c(m * n, NAN);
+            Gemm::multiply(a.data(), k, b.data(), n, c.data(), n, m, k, n, pool);
+            for (size_t i = 0; i < c.size(); i++) {
+                assert(abs(c[i] - want[i]) < 1e-9 * (k + 1));
+            }
+        }
+        Gemm::scalar_only = false;
+    }
+
+    // a chain along its optimal plan against left to right
+    vector<size_t> dims{30, 5, 40, 12, 3, 50, 8, 21};
+    vector<vector<double>> mats;
+    vector<const double *> ptrs;
+    for (size_t i = 0; i + 1 < dims.size(); i++) {
+        mats.emplace_back(dims[i] * dims[i + 1]);
+        for (auto &v : mats.back()) {
+            v = dist(gen);
+        }
+        ptrs.push_back(mats.back().data());
+    }
+    auto [cost, choice] = mat_mul_dp<uint64_t, uint32_t>(dims, pool);
+    ChainExecutor exec{dims, choice, ptrs, pool};
+    assert(exec.multiplies() == cost.at(0, dims.size() - 2));
+    const double *res = exec.run();
+    vector<double> want = mats[0];
+    for (size_t i = 1; i < mats.size(); i++) {
+        vector<double> next(dims[0] * dims[i + 1]);
+        naive_multiply(want.data(), mats[i].data(), next.data(), dims[0], dims[i], dims[i + 1]);
+        want = std::move(next);
+    }
+    for (size_t i = 0; i < want.size(); i++) {
+        assert(abs(res[i] - want[i]) < 1e-9 * (1 + abs(want[i])));
+    }
+}
+
+/* every split next to the last matrix, or next to the first */
+struct LeftDeep {
+    size_t at(size_t, size_t j) const { return j - 1; }
+};
+struct RightDeep {
+    size_t at(size_t i, size_t) const { return i; }
+};
+
+/* plans as deep as the chain, 1x2 times 2x2 signed permutations so every
+ * product is exact */
+template <typename Plan> void deep_plan_test(size_t n) {
+    mt19937 gen{19};
+    ThreadPool pool{3};
+    vector<size_t> dims(n + 1, 2);
+    dims[0] = 1;
+    vector<vector<double>> mats{{1, -1}};
+    for (size_t i = 1; i < n; i++) {
+        double s = gen() % 2 ? 1 : -1;
+        mats.push_back(gen() % 2 ? vector<double>{0, s, 1, 0} : vector<double>{s, 0, 0, -1});
+    }
+    vector<const double *> ptrs;
+    for (auto &m : mats) {
+        ptrs.push_back(m.data());
+    }
+    ChainExecutor exec{dims, Plan{}, ptrs, pool};
+    assert(exec.multiplies() == (is_same_v<Plan, LeftDeep> ? 4 * (n - 1) : 8 * (n - 2) + 4));
+    const double *res = exec.run();
+    double want[2] = {1, -1};
+    for (size_t i = 1; i < n; i++) {
+        double *m = mats[i].data();
+        double next[2] = {want[0] * m[0] + want[1] * m[2], want[0] * m[1] + want[1] * m[3]};
+        want[0] = next[0];
+        want[1] = next[1];
+    }
+    assert(res[0] == want[0] and res[1] == want[1]);
+}
+
+int main() {
+    all_layouts_test<uint16_t>(1, 1);
+    all_layouts_test<uint16_t>(37, 5);
+    all_layouts_test<uint32_t>(5, 37);
+    all_layouts_test<size_t>(100, 100);
+    all_layouts_test<long long>(17, 33);
+    // large enough to come from mmap
+    all_layouts_test<uint32_t>(1000, 700);
+    all_layouts_test<uint16_t>(300, 300, true);
+    cout << "table test passed\n";
+    task_group_test();
+    cout << "task group test passed\n";
+    cell_type_test();
+    cout << "cell type test passed\n";
+    io_test();
+    cout << "io test passed\n";
+    bit_lcs_test();
+    cout << "bit-parallel lcs test passed\n";
+    hirschberg_test();
+    cout << "hirschberg test passed\n";
+    {
+        ThreadPool pool{3};
+        wavefront_test<uint16_t>(pool);
+        wavefront_test<uint32_t>(pool);
+        wavefront_test<uint64_t>(pool);
+    }
+    cout << "wavefront test passed\n";
+    {
+        ThreadPool pool{3};
+        batch_lcs_test(pool);
+    }
+    cout << "batch lcs test passed\n";
+    for (size_t n : {1, 2, 7, 100}) {
+        triangle_test(n);
+    }
+    for (size_t n : {1, 2, 7, 100}) {
+        mirrored_triangle_test(n);
+    }
+    cout << "triangle test passed\n";
+    interval_test();
+    cout << "interval dp test passed\n";
+    chain_dp_test();
+    cout << "chain dp test passed\n";
+    hu_shing_test();
+    cout << "hu-shing test passed\n";
+    gemm_test();
+    cout << "gemm test passed\n";
+    deep_plan_test<LeftDeep>(200000);
+    deep_plan_test<RightDeep>(200000);
+    cout << "deep plan test passed\n";
+    cout.flush();
+}
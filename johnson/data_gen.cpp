@@ -60,13 +60,7 @@ int main() {
         cout << "original\n" << Graph{edges};
         // remove neg cycles
         while (true) {
-            auto connect_edges = edges;
-            vector<Edge> connect_vex_edges;
-            for(int i = 0; i < edges.size(); i++) {
-                connect_vex_edges.push_back({i, 1});
-            }
-            connect_edges.push_back(connect_vex_edges);
-            Graph connect_g{connect_edges};
+            Graph connect_g = Graph{edges}.with_source(1);
             BellmanFord bf{connect_g, connect_g.v_num() - 1};
             bf.run();
             auto neg_edge = bf.get_neg_cycle_edge();
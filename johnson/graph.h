@@ -1,7 +1,11 @@
 #pragma once
 
-#include <functional>
+#include <algorithm>
+#include <cstddef>
+#include <istream>
 #include <ostream>
+#include <span>
+#include <stdexcept>
 #include <vector>
 
 struct Edge {
@@ -10,27 +14,141 @@ struct Edge {
     bool operator==(const Edge &rhs) { return to == rhs.to; }
 };
 
+/* compressed sparse row: the out edges of vex are targets and weights in
+ * [offsets[vex], offsets[vex + 1]), every vertex's edges are contiguous and
+ * the whole graph is three flat arrays */
 class Graph {
   private:
-    const std::vector<std::vector<Edge>> &m_edges;
-    int m_v_num, m_e_num;
+    std::vector<int> m_offsets{0}, m_targets, m_weights;
 
   public:
-    Graph(const std::vector<std::vector<Edge>> &edges) : m_edges(edges) {
-        m_v_num = m_edges.size();
-        m_e_num = 0;
-        for (auto &e : m_edges) {
-            m_e_num += e.size();
+    /* the out edges of one vertex, yields Edge by value */
+    class EdgeRange {
+      private:
+        const int *m_to, *m_weight;
+        std::size_t m_size;
+
+      public:
+        class iterator {
+          private:
+            const int *to, *weight;
+
+          public:
+            typedef std::ptrdiff_t difference_type;
+            typedef Edge value_type;
+
+            iterator() = default;
+            iterator(const int *to_, const int *weight_) : to(to_), weight(weight_) {}
+            Edge operator*() const { return {*to, *weight}; }
+            iterator &operator++() {
+                to++;
+                weight++;
+                return *this;
+            }
+            iterator operator++(int) {
+                auto old = *this;
+                ++*this;
+                return old;
+            }
+            bool operator==(const iterator &rhs) const { return to == rhs.to; }
+        };
+
+        EdgeRange(std::span<const int> to, std::span<const int> weight)
+            : m_to(to.data()), m_weight(weight.data()), m_size(to.size()) {}
+        iterator begin() const { return {m_to, m_weight}; }
+        iterator end() const { return {m_to + m_size, m_weight + m_size}; }
+        std::size_t size() const { return m_size; }
+    };
+
+    /* appends edges grouped by source in ascending order, straight into the
+     * csr arrays. vertices without out edges are filled in as gaps */
+    class Builder {
+      private:
+        std::vector<int> offsets{0}, targets, weights;
+        int v_num = 0;
+
+      public:
+        void add(int from, int to, int weight) {
+            if (from + 1 < static_cast<int>(offsets.size()) - 1) {
+                throw std::invalid_argument("edges must be grouped by ascending source");
+            }
+            while (static_cast<int>(offsets.size()) <= from + 1) {
+                offsets.push_back(targets.size());
+            }
+            targets.push_back(to);
+            weights.push_back(weight);
+            offsets.back() = targets.size();
+            v_num = std::max({v_num, from + 1, to + 1});
+        }
+
+        /* a vertex that is only ever a target still gets a row */
+        Graph build() && {
+            while (static_cast<int>(offsets.size()) <= v_num) {
+                offsets.push_back(targets.size());
+            }
+            Graph g;
+            g.m_offsets = std::move(offsets);
+            g.m_targets = std::move(targets);
+            g.m_weights = std::move(weights);
+            return g;
+        }
+    };
+
+    Graph() = default;
+    Graph(const std::vector<std::vector<Edge>> &edges) {
+        Builder b;
+        for (int i = 0; i < static_cast<int>(edges.size()); i++) {
+            for (auto &e : edges[i]) {
+                b.add(i, e.to, e.weight);
+            }
+        }
+        *this = std::move(b).build();
+        /* trailing vertices without out edges keep their rows */
+        while (v_num() < static_cast<int>(edges.size())) {
+            m_offsets.push_back(m_targets.size());
+        }
+    }
+
+    /* "from to weight" lines, grouped by ascending from, as written by
+     * operator<< */
+    static Graph read(std::istream &is) {
+        Builder b;
+        int e_from, e_to, e_dist;
+        while (is >> e_from >> e_to >> e_dist) {
+            b.add(e_from, e_to, e_dist);
+        }
+        return std::move(b).build();
+    }
+
+    std::span<const int> targets(int vex) const {
+        return {m_targets.data() + m_offsets[vex], m_targets.data() + m_offsets[vex + 1]};
+    }
+    std::span<const int> weights(int vex) const {
+        return {m_weights.data() + m_offsets[vex], m_weights.data() + m_offsets[vex + 1]};
+    }
+    std::span<int> weights(int vex) {
+        return {m_weights.data() + m_offsets[vex], m_weights.data() + m_offsets[vex + 1]};
+    }
+    EdgeRange edges(int vex) const { return {targets(vex), weights(vex)}; }
+    int v_num() const { return m_offsets.size() - 1; }
+    int e_num() const { return m_targets.size(); }
+
+    /* a copy with one more vertex, v_num(), and an edge of the given weight
+     * from it to every other vertex */
+    Graph with_source(int weight) const {
+        Graph g = *this;
+        int src = v_num();
+        for (int i = 0; i < src; i++) {
+            g.m_targets.push_back(i);
+            g.m_weights.push_back(weight);
         }
+        g.m_offsets.push_back(g.m_targets.size());
+        return g;
     }
-    const std::vector<Edge> &edges(int vex) const { return m_edges[vex]; }
-    decltype(m_v_num) v_num() const { return m_v_num; }
-    decltype(m_e_num) e_num() const { return m_e_num; }
-    auto all_edges() const { return m_edges; }
 
     friend std::ostream &operator<<(std::ostream &os, const Graph &graph) {
         for (int i = 0; i < graph.v_num(); i++) {
-            for (auto &e : graph.edges(i)) {
+            for (auto &&e : graph.edges(i)) {
                 os << i << ' ' << e.to << ' ' << e.weight << '\n';
             }
         }
@@ -38,4 +156,4 @@ class Graph {
     }
 };
 
-std::ostream &operator<<(std::ostream &os, const Graph &graph);
\ No newline at end of file
+std::ostream &operator<<(std::ostream &os, const Graph &graph);
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "graph.h"
+#include "../common/thread_pool.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <limits>
 #include <memory>
@@ -10,14 +13,14 @@
 using namespace std;
 
 class SingleSource {
-  protected:
+  public:
     struct Prev {
         int vex, dist;
     };
 
   protected:
     std::vector<Prev> prev;
-    Graph g;
+    const Graph &g;
     int src;
 
     static constexpr int NO_PREV = -1;
@@ -55,7 +58,8 @@ class SingleSource {
   public:
     virtual void run() = 0;
 
-    optional<pair<vector<int>, int>> shortest_path(int to) {
+    /* walks a shortest path tree of src back from to */
+    static optional<pair<vector<int>, int>> path_to(const Prev *prev, int src, int to) {
         if (prev[to].dist == UNREACHABLE) {
             return nullopt;
         }
@@ -69,6 +73,8 @@ class SingleSource {
         return {{path, prev[to].dist}};
     }
 
+    optional<pair<vector<int>, int>> shortest_path(int to) { return path_to(prev.data(), src, to); }
+
     optional<int> shortest_dist(int to) {
         if (prev[to].dist == UNREACHABLE) {
             return nullopt;
@@ -88,8 +94,10 @@ class BellmanFord : public SingleSource {
         init_prev();
         for (int i = 0; i < g.v_num() - 1; i++) {
             for (int e_from = 0; e_from < g.v_num(); e_from++) {
-                for (auto &e : g.edges(e_from)) {
-                    relax(e_from, e.to, e.weight);
+                auto to = g.targets(e_from);
+                auto weight = g.weights(e_from);
+                for (size_t k = 0; k < to.size(); k++) {
+                    relax(e_from, to[k], weight[k]);
                 }
             }
         }
@@ -99,7 +107,7 @@ class BellmanFord : public SingleSource {
         int v;
         bool is_neg_edge = false;
         for (int e_from = 0; e_from < g.v_num(); e_from++) {
-            for (auto &e : g.edges(e_from)) {
+            for (auto &&e : g.edges(e_from)) {
                 if (prev[e_from].dist == UNREACHABLE) {
                     continue;
                 }
@@ -137,69 +145,80 @@ class Dijkstra : public SingleSource {
             return lhs.dist > rhs.dist;
         }
     };
-    priority_queue<DistVex, vector<DistVex>, CmpDist> q;
-    vector<bool> is_poped;
 
   public:
+    /* heap and visited bitmap of one search, a worker keeps them across
+     * sources so only the first search allocates */
+    struct Scratch {
+        vector<DistVex> q;
+        vector<bool> is_poped;
+    };
+
     Dijkstra(const Graph &g_, int src_) : SingleSource(g_, src_) {}
 
-    void init_queue() {
+    /* fills prev[0, v_num) with the shortest path tree of src. prev doubles
+     * as the tentative distances, a vertex is only pushed when it improves */
+    static void search(const Graph &g, int src, Prev *prev, Scratch &s) {
         for (int i = 0; i < g.v_num(); i++) {
-            if (i == src) {
-                q.push({0, i, NO_PREV});
-            } else {
-                q.push({UNREACHABLE, i, NO_PREV});
-            }
+            prev[i] = Prev{NO_PREV, UNREACHABLE};
         }
-        is_poped.resize(g.v_num(), false);
-    }
-
-    void run() override {
-        init_prev();
-        init_queue();
+        prev[src] = Prev{NO_PREV, 0};
+        s.is_poped.assign(g.v_num(), false);
+        s.q.clear();
+        s.q.push_back({0, src, NO_PREV});
 
-        while (!q.empty()) {
-            auto dist = q.top().dist;
-            auto v = q.top().vex;
-            auto prev_v = q.top().prev_vex;
+        while (!s.q.empty()) {
+            pop_heap(s.q.begin(), s.q.end(), CmpDist{});
+            auto [dist, v, prev_v] = s.q.back();
+            s.q.pop_back();
 
             // v is done
-            q.pop();
-            if (is_poped[v]) {
+            if (s.is_poped[v]) {
                 continue;
             }
-            is_poped[v] = true;
-            prev[v] = {prev_v, dist};
+            s.is_poped[v] = true;
 
             // relax
-            if (dist == UNREACHABLE) {
-                continue;
-            }
-            for (auto &&e : g.edges(v)) {
-                q.push({dist + e.weight, e.to, v});
+            auto to = g.targets(v);
+            auto weight = g.weights(v);
+            for (size_t k = 0; k < to.size(); k++) {
+                auto new_dist = dist + weight[k];
+                if (!s.is_poped[to[k]] && new_dist < prev[to[k]].dist) {
+                    prev[to[k]] = {v, new_dist};
+                    s.q.push_back({new_dist, to[k], v});
+                    push_heap(s.q.begin(), s.q.end(), CmpDist{});
+                }
             }
         }
     }
+
+    void run() override {
+        Scratch s;
+        search(g, src, prev.data(), s);
+    }
 };
 
 class Johnson {
   private:
-    Graph g;
-    vector<unique_ptr<Dijkstra>> dij_res;
+    /* sources a worker takes at a time, searches vary in cost so they are
+     * handed out in small chunks rather than split up front */
+    constexpr static int CHUNK = 8;
+
+    const Graph &g;
+    ThreadPool &pool;
+    /* g reweighted to non-negative edges */
+    Graph pos_g;
+    /* v_num x v_num, row src is the shortest path tree of src in pos_g */
+    vector<SingleSource::Prev> prev;
     vector<int> bf_dist;
 
+    SingleSource::Prev *row(int src) { return &prev[static_cast<size_t>(src) * pos_g.v_num()]; }
+
   public:
-    Johnson(const Graph &g_) : g(g_) {}
+    Johnson(const Graph &g_, ThreadPool &pool_ = ThreadPool::global()) : g(g_), pool(pool_) {}
 
     void run() {
-        auto edges = g.all_edges();
-        vector<Edge> connect_vex_edges;
-        for (int i = 0; i < edges.size(); i++) {
-            connect_vex_edges.push_back({i, 1});
-        }
-        auto connect_edges = edges;
-        connect_edges.push_back(connect_vex_edges);
-        Graph connect_g{connect_edges};
+        Graph connect_g = g.with_source(1);
 
         auto bf = BellmanFord(connect_g, connect_g.v_num() - 1);
         bf.run();
@@ -209,23 +228,36 @@ class Johnson {
             bf_dist[i] = bf.shortest_dist(i).value();
         }
 
+        pos_g = g;
         for (int i = 0; i < g.v_num(); i++) {
-            for (auto &&e : edges[i]) {
+            auto to = pos_g.targets(i);
+            auto weight = pos_g.weights(i);
+            for (size_t k = 0; k < to.size(); k++) {
                 // all vexs shoule be reachable
-                e.weight += bf_dist[i] - bf_dist[e.to];
+                weight[k] += bf_dist[i] - bf_dist[to[k]];
             }
         }
 
-        Graph pos_g{edges};
-        dij_res.resize(pos_g.v_num());
-        for (int i = 0; i < pos_g.v_num(); i++) {
-            dij_res[i].reset(new Dijkstra{pos_g, i});
-            dij_res[i]->run();
+        // one task per worker, each pulls chunks of sources until none are left
+        int v_num = pos_g.v_num();
+        prev.resize(static_cast<size_t>(v_num) * v_num);
+        atomic<int> next{0};
+        TaskGroup tg{pool};
+        for (size_t w = 0; w < pool.size(); w++) {
+            tg.run([this, &next, v_num] {
+                Dijkstra::Scratch scratch;
+                for (int begin; (begin = next.fetch_add(CHUNK)) < v_num;) {
+                    for (int src = begin; src < min(begin + CHUNK, v_num); src++) {
+                        Dijkstra::search(pos_g, src, row(src), scratch);
+                    }
+                }
+            });
         }
+        tg.wait();
     }
 
     optional<pair<vector<int>, int>> shortest_path(int src, int dst) {
-        auto op = dij_res[src]->shortest_path(dst);
+        auto op = SingleSource::path_to(row(src), src, dst);
         if(!op.has_value()) {
             return nullopt;
         }
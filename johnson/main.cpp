@@ -17,20 +17,8 @@ int main() {
 #endif
         ofstream output(out_file, ofstream::out);
 
-        vector<vector<Edge>> edges;
         // assume edge_from is in ascending order
-        int e_from, e_to, e_dist;
-        while (input.peek(), !input.eof()) {
-            input >> e_from >> e_to >> e_dist;
-            // remove \n
-            input.get();
-            if (edges.size() <= e_from) {
-                edges.push_back({});
-            }
-            edges[e_from].push_back(Edge{e_to, e_dist});
-        }
-
-        Graph g{edges};
+        Graph g = Graph::read(input);
         Johnson john{g};
         
         typedef chrono::high_resolution_clock Clock;
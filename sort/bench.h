@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sort.h"
+
+/* key wrapper that counts comparisons and element copies, sorted in a
+ * separate untimed run. bulk memcpy inside an algorithm is not seen */
+template <typename T> struct Counted {
+    T v;
+
+    static inline std::atomic<size_t> cmps{0}, moves{0};
+
+    Counted() = default;
+    Counted(T v_) : v(v_) {}
+    Counted(const Counted &rhs) : v(rhs.v) { moves.fetch_add(1, std::memory_order_relaxed); }
+    Counted &operator=(const Counted &rhs) {
+        v = rhs.v;
+        moves.fetch_add(1, std::memory_order_relaxed);
+        return *this;
+    }
+
+    bool operator<(const Counted &rhs) const {
+        cmps.fetch_add(1, std::memory_order_relaxed);
+        return v < rhs.v;
+    }
+    bool operator>(const Counted &rhs) const { return rhs < *this; }
+    bool operator<=(const Counted &rhs) const { return not(rhs < *this); }
+    bool operator>=(const Counted &rhs) const { return not(*this < rhs); }
+};
+
+enum class Dist { UNIFORM, SORTED, REVERSE, FEW_UNIQUE, ZIPF, ORGAN_PIPE };
+
+inline const char *dist_name(Dist d) {
+    const char *names[] = {"uniform", "sorted", "reverse", "few_unique", "zipf", "organ_pipe"};
+    return names[static_cast<int>(d)];
+}
+
+/* keys stay inside [0, 0xffff] so CountingSort can take every input */
+template <typename T> void gen_dist(T *arr, size_t len, Dist d, uint64_t seed) {
+    const unsigned MAX = 0xffffu;
+    std::mt19937_64 eng{seed};
+    std::uniform_int_distribution<unsigned> uni{0, MAX};
+    switch (d) {
+    case Dist::UNIFORM:
+    case Dist::SORTED:
+    case Dist::REVERSE:
+        for (size_t i = 0; i < len; i++) {
+            arr[i] = uni(eng);
+        }
+        if (d == Dist::SORTED) {
+            std::sort(arr, arr + len);
+        } else if (d == Dist::REVERSE) {
+            std::sort(arr, arr + len, [](const T &a, const T &b) { return b < a; });
+        }
+        break;
+    case Dist::FEW_UNIQUE: {
+        std::uniform_int_distribution<unsigned> few{0, 15};
+        for (size_t i = 0; i < len; i++) {
+            arr[i] = few(eng) * (MAX / 15);
+        }
+        break;
+    }
+    case Dist::ZIPF: {
+        /* rank r drawn with weight 1 / r over MAX + 1 ranks */
+        std::vector<double> cdf(MAX + 1);
+        double sum = 0;
+        for (size_t r = 0; r <= MAX; r++) {
+            sum += 1.0 / (r + 1);
+            cdf[r] = sum;
+        }
+        std::uniform_real_distribution<double> u{0, sum};
+        for (size_t i = 0; i < len; i++) {
+            arr[i] = std::lower_bound(cdf.begin(), cdf.end(), u(eng)) - cdf.begin();
+        }
+        break;
+    }
+    case Dist::ORGAN_PIPE:
+        for (size_t i = 0; i < len; i++) {
+            size_t up = i < len / 2 ? i : len - 1 - i;
+            arr[i] = up * MAX / std::max<size_t>(len / 2, 1);
+        }
+        break;
+    }
+}
+
+struct BenchResult {
+    std::string algo;
+    Dist dist;
+    size_t len, reps;
+    double median_ns, p99_ns, elems_per_s;
+    /* nan when the algorithm has no counted instance */
+    double cmps_per_elem, moves_per_elem;
+};
+
+/* every registered algorithm over every (distribution, length), warmup runs
+ * first and then reps timed runs on a fresh copy of the same input */
+template <typename T> class Benchmark {
+  private:
+    struct Entry {
+        std::string name;
+        std::unique_ptr<Sort<T>> sort;
+        std::unique_ptr<Sort<Counted<T>>> counted;
+    };
+    std::vector<Entry> algos;
+    size_t warmup, reps;
+    /* once a warmup run is slower than this, longer inputs are skipped */
+    double budget_ns;
+
+    static double percentile(std::vector<double> &v, double p) {
+        std::sort(v.begin(), v.end());
+        size_t rank = static_cast<size_t>(std::ceil(p * v.size()));
+        return v[std::clamp<size_t>(rank, 1, v.size()) - 1];
+    }
+
+  public:
+    Benchmark(size_t warmup_ = 2, size_t reps_ = 10, double budget_ns_ = 5e7)
+        : warmup(warmup_), reps(reps_), budget_ns(budget_ns_) {}
+
+    /* takes ownership, counted may be null for non-comparison sorts */
+    void add(std::string name, Sort<T> *sort, Sort<Counted<T>> *counted = nullptr) {
+        algos.push_back({name, std::unique_ptr<Sort<T>>{sort}, std::unique_ptr<Sort<Counted<T>>>{counted}});
+    }
+
+    std::vector<BenchResult> run(std::vector<size_t> lens, const std::vector<Dist> &dists,
+                                 uint64_t seed = 1) {
+        std::sort(lens.begin(), lens.end());
+        std::vector<BenchResult> res;
+        for (auto &&algo : algos) {
+            for (auto d : dists) {
+                for (auto len : lens) {
+                    std::vector<T> input(len), work(len);
+                    gen_dist(input.data(), len, d, seed);
+                    std::vector<double> samples;
+                    bool slow = false;
+                    for (size_t i = 0; i < warmup + reps; i++) {
+                        std::copy(input.begin(), input.end(), work.begin());
+                        double t = algo.sort->measure_time_sort(work.data(), len);
+                        if (i >= warmup) {
+                            samples.push_back(t);
+                        } else if (t > budget_ns) {
+                            /* too slow to repeat, keep the single sample */
+                            samples.push_back(t);
+                            slow = true;
+                            break;
+                        }
+                    }
+                    BenchResult r{algo.name, d, len, samples.size(), percentile(samples, 0.5),
+                                  percentile(samples, 0.99), 0, NAN, NAN};
+                    r.elems_per_s = len / (r.median_ns * 1e-9);
+                    if (algo.counted and not slow) {
+                        std::vector<Counted<T>> c(input.begin(), input.end());
+                        Counted<T>::cmps = 0;
+                        Counted<T>::moves = 0;
+                        algo.counted->sort(c.data(), len);
+                        r.cmps_per_elem = static_cast<double>(Counted<T>::cmps) / len;
+                        r.moves_per_elem = static_cast<double>(Counted<T>::moves) / len;
+                    }
+                    res.push_back(r);
+                    if (slow) {
+                        break;
+                    }
+                }
+            }
+        }
+        return res;
+    }
+
+    static void write_csv(std::ostream &os, const std::vector<BenchResult> &res) {
+        os << "algo,dist,len,reps,median_ns,p99_ns,elems_per_s,cmps_per_elem,moves_per_elem\n";
+        for (auto &&r : res) {
+            os << r.algo << ',' << dist_name(r.dist) << ',' << r.len << ',' << r.reps << ','
+               << r.median_ns << ',' << r.p99_ns << ',' << r.elems_per_s << ',';
+            if (not std::isnan(r.cmps_per_elem)) {
+                os << r.cmps_per_elem << ',' << r.moves_per_elem;
+            } else {
+                os << ',';
+            }
+            os << '\n';
+        }
+    }
+
+    static void write_json(std::ostream &os, const std::vector<BenchResult> &res) {
+        os << "[\n";
+        for (size_t i = 0; i < res.size(); i++) {
+            auto &&r = res[i];
+            os << "  {\"algo\": \"" << r.algo << "\", \"dist\": \"" << dist_name(r.dist)
+               << "\", \"len\": " << r.len << ", \"reps\": " << r.reps
+               << ", \"median_ns\": " << r.median_ns << ", \"p99_ns\": " << r.p99_ns
+               << ", \"elems_per_s\": " << r.elems_per_s;
+            if (not std::isnan(r.cmps_per_elem)) {
+                os << ", \"cmps_per_elem\": " << r.cmps_per_elem
+                   << ", \"moves_per_elem\": " << r.moves_per_elem;
+            }
+            os << '}' << (i + 1 < res.size() ? "," : "") << '\n';
+        }
+        os << "]\n";
+    }
+};
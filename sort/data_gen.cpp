@@ -1,8 +1,23 @@
 #include "sort_data.h"
+#include <algorithm>
 #include <iostream>
+#include <string>
 
-int main() {
+/* pass --binary to also write input.bin */
+int main(int argc, char *argv[]) {
     SortData<unsigned> data{"../input/input.txt", SortData<unsigned>::MAX_LEN};
     data.gen();
     data.write();
+    auto [src, len] = data.get();
+    /* read it back, a short or garbled file would only show up in the sorts */
+    SortData<unsigned> check{"../input/input.txt", len};
+    if (not check.read() or not std::equal(src, src + len, check.get().first)) {
+        std::cerr << "cannot read back ../input/input.txt\n";
+        return 1;
+    }
+    if (argc > 1 and std::string{argv[1]} == "--binary") {
+        SortData<unsigned> bin{"../input/input.bin", len};
+        std::copy(src, src + len, bin.get().first);
+        bin.write_binary();
+    }
 }
@@ -0,0 +1,357 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "sort.h"
+#include "sort_data.h"
+
+/* sort binary SortData files larger than memory: sorted runs of at most
+ * half of mem_budget are spilled to temp files, then k-way merged through a
+ * loser tree. every run reader and the writer double-buffer, the next block
+ * is read (written) on one io thread while the current one is consumed */
+template <typename T> class ExternalSort {
+  private:
+    /* smallest block worth a read() call, bounds the merge fan-in */
+    const static size_t MIN_BLOCK = 64 * 1024;
+
+    /* runs every read-ahead and write-behind in submission order, one thread
+     * for the whole sort instead of one per block */
+    class IoThread {
+      private:
+        std::mutex m;
+        std::condition_variable cv;
+        std::deque<std::function<void()>> jobs;
+        bool stop = false;
+        std::thread worker;
+
+        void work() {
+            while (true) {
+                std::function<void()> job;
+                {
+                    std::unique_lock lk{m};
+                    cv.wait(lk, [this] { return stop or not jobs.empty(); });
+                    if (jobs.empty()) {
+                        return;
+                    }
+                    job = std::move(jobs.front());
+                    jobs.pop_front();
+                }
+                job();
+            }
+        }
+
+      public:
+        IoThread() : worker([this] { work(); }) {}
+        IoThread(const IoThread &) = delete;
+        ~IoThread() {
+            {
+                std::lock_guard lk{m};
+                stop = true;
+            }
+            cv.notify_one();
+            worker.join();
+        }
+
+        template <typename F> auto submit(F f) -> std::future<decltype(f())> {
+            auto task = std::make_shared<std::packaged_task<decltype(f())()>>(std::move(f));
+            auto res = task->get_future();
+            {
+                std::lock_guard lk{m};
+                jobs.emplace_back([task] { (*task)(); });
+            }
+            cv.notify_one();
+            return res;
+        }
+    };
+
+    Sort<T> &run_sort;
+    size_t mem_budget;
+    std::string tmp_dir;
+    size_t tmp_cnt = 0;
+    IoThread io;
+
+    static bool read_full(int fd, void *buf, size_t bytes) {
+        auto p = static_cast<char *>(buf);
+        while (bytes > 0) {
+            auto n = ::read(fd, p, bytes);
+            if (n <= 0) {
+                return false;
+            }
+            p += n;
+            bytes -= n;
+        }
+        return true;
+    }
+
+    static bool write_full(int fd, const void *buf, size_t bytes) {
+        auto p = static_cast<const char *>(buf);
+        while (bytes > 0) {
+            auto n = ::write(fd, p, bytes);
+            if (n <= 0) {
+                return false;
+            }
+            p += n;
+            bytes -= n;
+        }
+        return true;
+    }
+
+    /* sequential reader of one sorted file, header already validated */
+    class RunReader {
+      private:
+        IoThread &io;
+        int fd;
+        uint64_t left;
+        std::vector<T> cur, next;
+        size_t pos = 0, len = 0;
+        std::future<size_t> pending;
+
+        size_t fill(std::vector<T> &buf) {
+            size_t n = std::min<uint64_t>(left, buf.size());
+            left -= n;
+            return read_full(fd, buf.data(), n * sizeof(T)) ? n : 0;
+        }
+
+        void prefetch() {
+            pending = io.submit([this] { return fill(next); });
+        }
+
+      public:
+        RunReader(IoThread &io_, int fd_, uint64_t count, size_t block)
+            : io(io_), fd(fd_), left(count), cur(block), next(block) {
+            len = fill(cur);
+            prefetch();
+        }
+        ~RunReader() {
+            if (pending.valid()) {
+                pending.wait();
+            }
+            close(fd);
+        }
+
+        bool empty() const { return pos == len; }
+        const T &head() const { return cur[pos]; }
+        void pop() {
+            if (++pos < len) {
+                return;
+            }
+            len = pending.get();
+            cur.swap(next);
+            pos = 0;
+            if (len > 0) {
+                prefetch();
+            }
+        }
+    };
+
+    /* buffered writer, a full block is written out while the other fills */
+    class RunWriter {
+      private:
+        IoThread &io;
+        int fd;
+        std::vector<T> cur, flushing;
+        size_t len = 0;
+        uint64_t expected, pushed = 0;
+        std::future<bool> pending;
+        bool ok = true;
+
+        void flush() {
+            if (pending.valid()) {
+                ok = pending.get() and ok;
+            }
+            cur.swap(flushing);
+            pending = io.submit([this, n = len] {
+                return write_full(fd, flushing.data(), n * sizeof(T));
+            });
+            len = 0;
+        }
+
+      public:
+        RunWriter(IoThread &io_, int fd_, uint64_t count, size_t block)
+            : io(io_), fd(fd_), cur(block), flushing(block), expected(count) {
+            auto h = SortDataHeader::make<T>(count);
+            ok = write_full(fd, &h, sizeof(h));
+        }
+
+        void push(const T &x) {
+            cur[len++] = x;
+            pushed++;
+            if (len == cur.size()) {
+                flush();
+            }
+        }
+
+        /* drain and close, false if any write failed or a reader came up short */
+        bool finish() {
+            flush();
+            ok = pending.get() and ok;
+            return close(fd) == 0 and ok and pushed == expected;
+        }
+    };
+
+    /* tree[0] is the overall winner, tree[1, k) hold the loser of each match.
+     * leaf i sits at node k + i, exhausted runs lose every match */
+    class LoserTree {
+      private:
+        std::vector<std::unique_ptr<RunReader>> &runs;
+        std::vector<size_t> tree;
+
+        bool less(size_t a, size_t b) const {
+            if (runs[a]->empty() or runs[b]->empty()) {
+                return runs[b]->empty() and not runs[a]->empty();
+            }
+            /* ties go to the earlier run, keeps the merge stable */
+            return runs[a]->head() < runs[b]->head() or
+                   (not(runs[b]->head() < runs[a]->head()) and a < b);
+        }
+
+        size_t build(size_t node) {
+            size_t k = runs.size();
+            if (node >= k) {
+                return node - k;
+            }
+            size_t l = build(2 * node), r = build(2 * node + 1);
+            bool l_wins = less(l, r);
+            tree[node] = l_wins ? r : l;
+            return l_wins ? l : r;
+        }
+
+      public:
+        LoserTree(std::vector<std::unique_ptr<RunReader>> &runs_)
+            : runs(runs_), tree(runs_.size()) {
+            tree[0] = build(1);
+        }
+
+        bool empty() const { return runs[tree[0]]->empty(); }
+        const T &top() const { return runs[tree[0]]->head(); }
+
+        void pop() {
+            size_t winner = tree[0];
+            runs[winner]->pop();
+            for (size_t node = (runs.size() + winner) / 2; node >= 1; node /= 2) {
+                if (less(tree[node], winner)) {
+                    std::swap(tree[node], winner);
+                }
+            }
+            tree[0] = winner;
+        }
+    };
+
+    static int open_sorted(const std::string &file, uint64_t &count) {
+        int fd = open(file.c_str(), O_RDONLY);
+        SortDataHeader h;
+        if (fd < 0 or not read_full(fd, &h, sizeof(h)) or not h.valid<T>()) {
+            if (fd >= 0) {
+                close(fd);
+            }
+            return -1;
+        }
+        count = h.count;
+        return fd;
+    }
+
+    std::string tmp_name() {
+        return tmp_dir + "/ext_sort_" + std::to_string(getpid()) + "_" + std::to_string(tmp_cnt++) + ".bin";
+    }
+
+    bool merge(const std::vector<std::string> &in, const std::string &out) {
+        /* memory split evenly over 2 buffers per reader and 2 for the writer */
+        size_t block = std::max<size_t>(mem_budget / sizeof(T) / (2 * in.size() + 2), MIN_BLOCK / sizeof(T));
+        std::vector<std::unique_ptr<RunReader>> runs;
+        uint64_t total = 0;
+        for (auto &&file : in) {
+            uint64_t count;
+            int fd = open_sorted(file, count);
+            if (fd < 0) {
+                return false;
+            }
+            total += count;
+            runs.emplace_back(new RunReader{io, fd, count, block});
+        }
+        int fd = open(out.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        RunWriter w{io, fd, total, block};
+        if (not runs.empty()) {
+            LoserTree lt{runs};
+            while (not lt.empty()) {
+                w.push(lt.top());
+                lt.pop();
+            }
+        }
+        return w.finish();
+    }
+
+  public:
+    ExternalSort(Sort<T> &run_sort_, size_t mem_budget_, std::string tmp_dir_ = "/tmp")
+        : run_sort(run_sort_), mem_budget(mem_budget_), tmp_dir(tmp_dir_) {}
+
+    /* in and out are binary SortData files, false on any io error */
+    bool sort(const std::string &in, const std::string &out) {
+        uint64_t count;
+        int fd = open_sorted(in, count);
+        if (fd < 0) {
+            return false;
+        }
+        /* phase 1, sorted runs. a run gets half the budget, the run sorter
+         * may need as much scratch again (BottomUpMergeSort does) */
+        size_t run_len = std::max<size_t>(mem_budget / sizeof(T) / 2, 1);
+        std::unique_ptr<T[]> buf{new T[std::min<uint64_t>(run_len, std::max<uint64_t>(count, 1))]};
+        std::vector<std::string> runs;
+        bool ok = true;
+        for (uint64_t done = 0; ok and done < count; done += run_len) {
+            size_t n = std::min<uint64_t>(run_len, count - done);
+            ok = read_full(fd, buf.get(), n * sizeof(T));
+            if (not ok) {
+                break;
+            }
+            run_sort.sort(buf.get(), n);
+            runs.push_back(tmp_name());
+            int run_fd = open(runs.back().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            auto h = SortDataHeader::make<T>(n);
+            ok = run_fd >= 0 and write_full(run_fd, &h, sizeof(h)) and
+                 write_full(run_fd, buf.get(), n * sizeof(T));
+            ok = run_fd >= 0 and close(run_fd) == 0 and ok;
+        }
+        close(fd);
+        buf.reset();
+        /* the merge buffers take the whole budget */
+        run_sort.release();
+
+        /* phase 2, merge passes until one is left, fan-in limited so every
+         * reader still gets MIN_BLOCK sized buffers */
+        size_t fan_in = std::max<size_t>(mem_budget / (2 * MIN_BLOCK), 3) - 1;
+        while (ok and runs.size() > fan_in) {
+            std::vector<std::string> merged;
+            for (size_t i = 0; i < runs.size(); i += fan_in) {
+                std::vector<std::string> group(runs.begin() + i, runs.begin() + std::min(i + fan_in, runs.size()));
+                merged.push_back(tmp_name());
+                ok = ok and merge(group, merged.back());
+                for (auto &&file : group) {
+                    unlink(file.c_str());
+                }
+            }
+            runs.swap(merged);
+        }
+        ok = ok and merge(runs, out);
+        for (auto &&file : runs) {
+            unlink(file.c_str());
+        }
+        return ok;
+    }
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <ostream>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "sort.h"
+
+/* hardware counters of the calling thread via perf_event_open. every counter
+ * is opened on its own so a pmu that lacks one still reports the others, and
+ * one that refuses everything (containers, perf_event_paranoid) leaves the
+ * whole set unavailable without complaint. threads that already run, like
+ * the pool's, are not counted and inherit would not reach them either, so
+ * every sample also says how much of the process cpu time it covers */
+class PerfCounters {
+  public:
+    enum Event { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, EVENT_NUM };
+
+    struct Sample {
+        /* -1 when the event could not be opened */
+        int64_t val[EVENT_NUM];
+        /* calling thread's share of the process cpu time, below 1 when other
+         * threads did part of the work and the counts are partial */
+        double coverage;
+    };
+
+  private:
+    int fds[EVENT_NUM];
+    double thread_start, process_start;
+
+    static double cpu_seconds(clockid_t clock) {
+        timespec ts;
+        clock_gettime(clock, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    static int open_event(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+  public:
+    PerfCounters() {
+        const uint64_t l1d_miss = PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                                  PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+        fds[CYCLES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds[INSTRUCTIONS] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds[L1D_MISSES] = open_event(PERF_TYPE_HW_CACHE, l1d_miss);
+        fds[LLC_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        fds[BRANCH_MISSES] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    }
+    PerfCounters(const PerfCounters &) = delete;
+    ~PerfCounters() {
+        for (auto fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    bool available() const {
+        for (auto fd : fds) {
+            if (fd >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void start() {
+        thread_start = cpu_seconds(CLOCK_THREAD_CPUTIME_ID);
+        process_start = cpu_seconds(CLOCK_PROCESS_CPUTIME_ID);
+        for (auto fd : fds) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    }
+
+    Sample stop() {
+        Sample s;
+        for (int i = 0; i < EVENT_NUM; i++) {
+            s.val[i] = -1;
+            if (fds[i] < 0) {
+                continue;
+            }
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            /* value, time enabled, time running. scale up when multiplexed */
+            uint64_t buf[3];
+            if (read(fds[i], buf, sizeof(buf)) == sizeof(buf) and buf[2] > 0) {
+                s.val[i] = buf[2] < buf[1] ? std::llround(static_cast<double>(buf[0]) * buf[1] / buf[2]) : buf[0];
+            }
+        }
+        double thread = cpu_seconds(CLOCK_THREAD_CPUTIME_ID) - thread_start;
+        double process = cpu_seconds(CLOCK_PROCESS_CPUTIME_ID) - process_start;
+        s.coverage = process > 0 ? std::min(1.0, thread / process) : 1;
+        return s;
+    }
+
+    static void write_header(std::ostream &os) {
+        os << "cycles instructions l1d_misses llc_misses branch_misses coverage\n";
+    }
+
+    static void write(std::ostream &os, const Sample &s) {
+        for (int i = 0; i < EVENT_NUM; i++) {
+            if (s.val[i] < 0) {
+                os << '-';
+            } else {
+                os << s.val[i];
+            }
+            os << ' ';
+        }
+        os << std::round(s.coverage * 100) / 100 << '\n';
+    }
+};
+
+/* wraps any Sort<T>, counters cover the sort call only. work handed to pool
+ * threads that already exist is not counted, coverage says how much is */
+template <typename T> class PerfSort : public Sort<T> {
+  private:
+    Sort<T> &inner;
+    PerfCounters counters;
+    PerfCounters::Sample last;
+
+  public:
+    explicit PerfSort(Sort<T> &inner_) : inner(inner_) {}
+
+    void sort(T *arr, size_t len) override {
+        counters.start();
+        inner.sort(arr, len);
+        last = counters.stop();
+    }
+
+    bool available() const { return counters.available(); }
+    const PerfCounters::Sample &last_sample() const { return last; }
+};
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+#include <limits>
+#include <utility>
+
+/* bitonic sorting networks and merge kernels for 32-bit unsigned keys.
+ * kernels are compiled per instruction set with target attributes and the
+ * best one is picked once at runtime by cpuid, no global -mavx2 needed */
+
+enum class SimdLevel { SCALAR, SSE4, AVX2 };
+
+/* the widest level the cpu runs, by cpuid once */
+inline SimdLevel simd_support() {
+    static const SimdLevel level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.1")) {
+            return SimdLevel::SSE4;
+        }
+        return SimdLevel::SCALAR;
+    }();
+    return level;
+}
+
+/* tests lower this to run the narrower kernels on a wider cpu */
+inline SimdLevel simd_cap = SimdLevel::AVX2;
+
+/* the level every kernel dispatches on */
+inline SimdLevel simd_level() { return std::min(simd_support(), simd_cap); }
+
+/* largest block the networks sort in registers */
+const size_t SIMD_SORT_MAX = 64;
+
+/* bitonic network on N keys, stages k_first..N. k_first = 2 sorts the block,
+ * k_first = N merges a bitonic block */
+template <size_t N> void bitonic_network_scalar(uint32_t *a, size_t k_first) {
+    for (size_t k = k_first; k <= N; k *= 2) {
+        for (size_t j = k / 2; j > 0; j /= 2) {
+            for (size_t i = 0; i < N; i++) {
+                size_t l = i ^ j;
+                if (l > i) {
+                    uint32_t mn = std::min(a[i], a[l]), mx = std::max(a[i], a[l]);
+                    bool asc = (i & k) == 0;
+                    a[i] = asc ? mn : mx;
+                    a[l] = asc ? mx : mn;
+                }
+            }
+        }
+    }
+}
+
+template <size_t N>
+__attribute__((target("sse4.1"))) void bitonic_network_sse4(uint32_t *a, size_t k_first) {
+    const size_t R = N / 4;
+    __m128i v[R];
+    for (size_t r = 0; r < R; r++) {
+        v[r] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&a[4 * r]));
+    }
+    const __m128i lane = _mm_setr_epi32(0, 1, 2, 3), zero = _mm_setzero_si128();
+    for (size_t k = k_first; k <= N; k *= 2) {
+        for (size_t j = k / 2; j > 0; j /= 2) {
+            if (j >= 4) {
+                /* partner lives in another register, direction is per register */
+                size_t rj = j / 4;
+                for (size_t r = 0; r < R; r++) {
+                    if ((r & rj) == 0) {
+                        __m128i mn = _mm_min_epu32(v[r], v[r + rj]);
+                        __m128i mx = _mm_max_epu32(v[r], v[r + rj]);
+                        bool asc = ((4 * r) & k) == 0;
+                        v[r] = asc ? mn : mx;
+                        v[r + rj] = asc ? mx : mn;
+                    }
+                }
+                continue;
+            }
+            for (size_t r = 0; r < R; r++) {
+                __m128i perm = j == 1 ? _mm_shuffle_epi32(v[r], 0xb1) : _mm_shuffle_epi32(v[r], 0x4e);
+                __m128i mn = _mm_min_epu32(v[r], perm), mx = _mm_max_epu32(v[r], perm);
+                __m128i g = _mm_add_epi32(_mm_set1_epi32(4 * r), lane);
+                __m128i lower = _mm_cmpeq_epi32(_mm_and_si128(g, _mm_set1_epi32(j)), zero);
+                __m128i asc = _mm_cmpeq_epi32(_mm_and_si128(g, _mm_set1_epi32(k)), zero);
+                v[r] = _mm_blendv_epi8(mx, mn, _mm_cmpeq_epi32(lower, asc));
+            }
+        }
+    }
+    for (size_t r = 0; r < R; r++) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(&a[4 * r]), v[r]);
+    }
+}
+
+template <size_t N>
+__attribute__((target("avx2"))) void bitonic_network_avx2(uint32_t *a, size_t k_first) {
+    const size_t R = N / 8;
+    __m256i v[R];
+    for (size_t r = 0; r < R; r++) {
+        v[r] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&a[8 * r]));
+    }
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i zero = _mm256_setzero_si256();
+    for (size_t k = k_first; k <= N; k *= 2) {
+        for (size_t j = k / 2; j > 0; j /= 2) {
+            if (j >= 8) {
+                size_t rj = j / 8;
+                for (size_t r = 0; r < R; r++) {
+                    if ((r & rj) == 0) {
+                        __m256i mn = _mm256_min_epu32(v[r], v[r + rj]);
+                        __m256i mx = _mm256_max_epu32(v[r], v[r + rj]);
+                        bool asc = ((8 * r) & k) == 0;
+                        v[r] = asc ? mn : mx;
+                        v[r + rj] = asc ? mx : mn;
+                    }
+                }
+                continue;
+            }
+            for (size_t r = 0; r < R; r++) {
+                __m256i perm = j == 1   ? _mm256_shuffle_epi32(v[r], 0xb1)
+                               : j == 2 ? _mm256_shuffle_epi32(v[r], 0x4e)
+                                        : _mm256_permute2x128_si256(v[r], v[r], 1);
+                __m256i mn = _mm256_min_epu32(v[r], perm), mx = _mm256_max_epu32(v[r], perm);
+                __m256i g = _mm256_add_epi32(_mm256_set1_epi32(8 * r), lane);
+                __m256i lower = _mm256_cmpeq_epi32(_mm256_and_si256(g, _mm256_set1_epi32(j)), zero);
+                __m256i asc = _mm256_cmpeq_epi32(_mm256_and_si256(g, _mm256_set1_epi32(k)), zero);
+                v[r] = _mm256_blendv_epi8(mx, mn, _mm256_cmpeq_epi32(lower, asc));
+            }
+        }
+    }
+    for (size_t r = 0; r < R; r++) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(&a[8 * r]), v[r]);
+    }
+}
+
+template <size_t N> void bitonic_network(uint32_t *a, size_t k_first) {
+    switch (simd_level()) {
+    case SimdLevel::AVX2:
+        bitonic_network_avx2<N>(a, k_first);
+        break;
+    case SimdLevel::SSE4:
+        bitonic_network_sse4<N>(a, k_first);
+        break;
+    default:
+        bitonic_network_scalar<N>(a, k_first);
+    }
+}
+
+inline void bitonic_network(uint32_t *a, size_t n, size_t k_first) {
+    switch (n) {
+    case 8:
+        return bitonic_network<8>(a, k_first);
+    case 16:
+        return bitonic_network<16>(a, k_first);
+    case 32:
+        return bitonic_network<32>(a, k_first);
+    default:
+        return bitonic_network<64>(a, k_first);
+    }
+}
+
+/* sort len <= SIMD_SORT_MAX keys, padded with max up to a power of two */
+inline void bitonic_sort_u32(uint32_t *arr, size_t len) {
+    if (len <= 1) {
+        return;
+    }
+    alignas(32) uint32_t buf[SIMD_SORT_MAX];
+    size_t n = std::max<size_t>(8, std::bit_ceil(len));
+    std::memcpy(buf, arr, len * sizeof(uint32_t));
+    std::fill(buf + len, buf + n, std::numeric_limits<uint32_t>::max());
+    bitonic_network(buf, n, 2);
+    std::memcpy(arr, buf, len * sizeof(uint32_t));
+}
+
+/* merge sorted arr[0, n / 2) and arr[n / 2, n) in place, n in 16..64 and a
+ * power of two. reversing the upper half turns the pair into one bitonic run */
+inline void bitonic_merge_u32(uint32_t *arr, size_t n) {
+    std::reverse(arr + n / 2, arr + n);
+    bitonic_network(arr, n, n);
+}
+
+/* ascending half-cleaner stages 4, 2, 1 on one bitonic register */
+__attribute__((target("avx2"))) inline __m256i bitonic_clean_8(__m256i v) {
+    __m256i p = _mm256_permute2x128_si256(v, v, 1);
+    v = _mm256_blend_epi32(_mm256_min_epu32(v, p), _mm256_max_epu32(v, p), 0xf0);
+    p = _mm256_shuffle_epi32(v, 0x4e);
+    v = _mm256_blend_epi32(_mm256_min_epu32(v, p), _mm256_max_epu32(v, p), 0xcc);
+    p = _mm256_shuffle_epi32(v, 0xb1);
+    return _mm256_blend_epi32(_mm256_min_epu32(v, p), _mm256_max_epu32(v, p), 0xaa);
+}
+
+/* merge two sorted registers: lo gets the 8 smallest, hi the rest */
+__attribute__((target("avx2"))) inline void bitonic_merge_8x8(__m256i &lo, __m256i &hi) {
+    hi = _mm256_permutevar8x32_epi32(hi, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+    __m256i l = _mm256_min_epu32(lo, hi), h = _mm256_max_epu32(lo, hi);
+    lo = bitonic_clean_8(l);
+    hi = bitonic_clean_8(h);
+}
+
+inline void merge_u32_scalar(const uint32_t *a, size_t la, const uint32_t *b, size_t lb,
+                             uint32_t *out) {
+    size_t i = 0, j = 0;
+    while (i < la and j < lb) {
+        *out++ = b[j] < a[i] ? b[j++] : a[i++];
+    }
+    out = std::copy(a + i, a + la, out);
+    std::copy(b + j, b + lb, out);
+}
+
+/* 8 keys per step: merge the carried register with the next block of
+ * whichever input has the smaller head, emit the low half */
+__attribute__((target("avx2"))) inline void merge_u32_avx2(const uint32_t *a, size_t la,
+                                                           const uint32_t *b, size_t lb,
+                                                           uint32_t *out) {
+    __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+    __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b));
+    size_t i = 8, j = 8;
+    while (true) {
+        bitonic_merge_8x8(lo, hi);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), lo);
+        out += 8;
+        bool take_a = j >= lb or (i < la and a[i] <= b[j]);
+        if (take_a ? i + 8 > la : j + 8 > lb) {
+            break;
+        }
+        const uint32_t *next = take_a ? &a[i] : &b[j];
+        lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(next));
+        (take_a ? i : j) += 8;
+    }
+    /* carried register plus the two tails, less than 24 + tail keys */
+    alignas(32) uint32_t carry[8];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(carry), hi);
+    size_t c = 0;
+    while (c < 8 or i < la or j < lb) {
+        uint32_t best = std::numeric_limits<uint32_t>::max();
+        int from = -1;
+        if (c < 8) {
+            best = carry[c], from = 0;
+        }
+        if (i < la and (from < 0 or a[i] < best)) {
+            best = a[i], from = 1;
+        }
+        if (j < lb and (from < 0 or b[j] < best)) {
+            best = b[j], from = 2;
+        }
+        *out++ = best;
+        (from == 0 ? c : from == 1 ? i : j)++;
+    }
+}
+
+/* smallest and largest of len >= 1 keys */
+__attribute__((target("avx2"))) inline std::pair<uint32_t, uint32_t> minmax_u32_avx2(const uint32_t *arr,
+                                                                                     size_t len) {
+    __m256i lo = _mm256_set1_epi32(arr[0]), hi = lo;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&arr[i]));
+        lo = _mm256_min_epu32(lo, v);
+        hi = _mm256_max_epu32(hi, v);
+    }
+    alignas(32) uint32_t l[8], h[8];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(l), lo);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(h), hi);
+    uint32_t mn = *std::min_element(l, l + 8), mx = *std::max_element(h, h + 8);
+    for (; i < len; i++) {
+        mn = std::min(mn, arr[i]);
+        mx = std::max(mx, arr[i]);
+    }
+    return {mn, mx};
+}
+
+inline std::pair<uint32_t, uint32_t> minmax_u32(const uint32_t *arr, size_t len) {
+    if (simd_level() == SimdLevel::AVX2) {
+        return minmax_u32_avx2(arr, len);
+    }
+    uint32_t mn = arr[0], mx = arr[0];
+    for (size_t i = 1; i < len; i++) {
+        mn = std::min(mn, arr[i]);
+        mx = std::max(mx, arr[i]);
+    }
+    return {mn, mx};
+}
+
+/* merge sorted a and b into out */
+inline void merge_u32(const uint32_t *a, size_t la, const uint32_t *b, size_t lb,
+                      uint32_t *out) {
+    if (la >= 8 and lb >= 8 and simd_level() == SimdLevel::AVX2) {
+        merge_u32_avx2(a, la, b, lb, out);
+    } else {
+        merge_u32_scalar(a, la, b, lb, out);
+    }
+}
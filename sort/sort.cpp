@@ -1,38 +1,63 @@
+#include <algorithm>
+#include <bit>
+#include <cassert>
 #include <chrono>
+#include <climits>
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <random>
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <cstring>
+#include <tuple>
+#include <type_traits>
 
+#include "../common/thread_pool.h"
+#include "bench.h"
+#include "external_sort.h"
+#include "perf_counters.h"
+#include "simd_sort.h"
+#include "sort.h"
 #include "sort_data.h"
 
-/* common interface for time measurement*/
-template <typename T> class Sort {
-  public:
-    virtual ~Sort() {};
-    virtual void sort(T *arr, size_t len) = 0;
-    size_t measure_time_sort(T *arr, size_t len) {
-        typedef std::chrono::high_resolution_clock clk;
-        auto start = clk::now();
-        sort(arr, len);
-        auto end = clk::now();
-        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
-    }
-};
-
 template <typename T> void swap(T &a, T &b) {
     T tmp = a;
     a = b;
     b = tmp;
 }
 
+/* stable, for short ranges */
+template <typename T> void insertion_sort(T *arr, size_t len) {
+    for (size_t i = 1; i < len; i++) {
+        T key = arr[i];
+        size_t j = i;
+        while (j > 0 and key < arr[j - 1]) {
+            arr[j] = arr[j - 1];
+            j--;
+        }
+        arr[j] = key;
+    }
+}
+
+/* base case of the divide and conquer sorts, sorting network when the keys
+ * fit one, insertion sort otherwise */
+template <typename T> void small_sort(T *arr, size_t len) {
+    if constexpr (std::is_same_v<T, uint32_t>) {
+        bitonic_sort_u32(arr, len);
+    } else {
+        insertion_sort(arr, len);
+    }
+}
+
 template <typename T> class QuickSort : public Sort<T> {
   public:
     void sort(T *arr, size_t len) override {
-        if (len <= 1) {
+        if (len <= SIMD_SORT_MAX) {
+            small_sort(arr, len);
             return;
         }
         size_t l = 0, r = 0;
@@ -88,24 +113,318 @@ template <typename T> class HeapSort : public Sort<T> {
     }
 };
 
+/* d-ary max-heap. sift is floyd's bottom-up: push the hole down to a leaf
+ * along the larger children, then climb back up to place the key. the
+ * children of a node are adjacent, and the heap starts far enough into the
+ * array that every sibling group starts on a D-key boundary, so with D
+ * keys to a 16, 32 or 64 byte group one sift level reads one cache line */
+template <typename T, size_t D = 4> class DaryHeapSort : public Sort<T> {
+    static_assert(D >= 2, "heap needs at least two children per node");
+
+  public:
+    void sort(T *arr, size_t len) override {
+        size_t skip = align_skip(arr);
+        if (len <= skip + 1) {
+            insertion_sort(arr, len);
+            return;
+        }
+        /* the skip smallest keys go in front, sorted, ahead of the heap */
+        insertion_sort(arr, skip);
+        for (size_t i = skip; skip > 0 and i < len; i++) {
+            if (arr[i] < arr[skip - 1]) {
+                swap(arr[i], arr[skip - 1]);
+                for (size_t j = skip - 1; j > 0 and arr[j] < arr[j - 1]; j--) {
+                    swap(arr[j], arr[j - 1]);
+                }
+            }
+        }
+        T *heap = arr + skip;
+        len -= skip;
+        for (size_t i = (len - 2) / D + 1; i > 0; i--) {
+            sift(heap, len, i - 1);
+        }
+        while (len > 1) {
+            len--;
+            T x = heap[len];
+            heap[len] = heap[0];
+            heap[0] = x;
+            sift(heap, len, 0);
+        }
+    }
+
+    static void sift(T *arr, size_t len, size_t root) {
+        T x = arr[root];
+        size_t hole = root;
+        while (true) {
+            size_t first = D * hole + 1;
+            if (first >= len) {
+                break;
+            }
+            /* the running max stays in a register, selects instead of branches */
+            size_t last = std::min(first + D, len), max = first;
+            T best = arr[first];
+            for (size_t c = first + 1; c < last; c++) {
+                bool more = best < arr[c];
+                max = more ? c : max;
+                best = more ? arr[c] : best;
+            }
+            arr[hole] = best;
+            hole = max;
+        }
+        while (hole > root) {
+            size_t parent = (hole - 1) / D;
+            if (not(arr[parent] < x)) {
+                break;
+            }
+            arr[hole] = arr[parent];
+            hole = parent;
+        }
+        arr[hole] = x;
+    }
+
+  private:
+    /* keys to leave out in front so that arr[skip + 1], the first child of
+     * the root, starts a D-key group. zero for keys that are not aligned */
+    static size_t align_skip(const T *arr) {
+        auto addr = reinterpret_cast<uintptr_t>(arr);
+        if (addr % sizeof(T) != 0) {
+            return 0;
+        }
+        return (D - 1 - addr / sizeof(T) % D) % D;
+    }
+};
+
+/* three-way: [0, lt) < p, [lt, gt) == p, [gt, len) > p */
+template <typename T> void partition3(T *arr, size_t len, const T p, size_t &lt, size_t &gt) {
+    size_t i = 0;
+    lt = 0;
+    gt = len;
+    while (i < gt) {
+        if (arr[i] < p) {
+            swap(arr[lt++], arr[i++]);
+        } else if (p < arr[i]) {
+            swap(arr[i], arr[--gt]);
+        } else {
+            i++;
+        }
+    }
+}
+
+/* introsort, subranges above PAR_CUTOFF are forked onto the pool */
+template <typename T> class ParallelQuickSort : public Sort<T> {
+  private:
+    const static size_t SMALL_CUTOFF = SIMD_SORT_MAX;
+    const static size_t NINTHER_CUTOFF = 128;
+    const static size_t PAR_CUTOFF = 1 << 14;
+    ThreadPool &pool;
+
+  public:
+    explicit ParallelQuickSort(ThreadPool &pool_ = ThreadPool::global()) : pool(pool_) {}
+
+    void sort(T *arr, size_t len) override {
+        if (len <= 1) {
+            return;
+        }
+        TaskGroup tg{pool};
+        sort(arr, len, 2 * static_cast<size_t>(std::log2(len)), tg);
+        tg.wait();
+    }
+
+  private:
+    static const T &median3(const T &a, const T &b, const T &c) {
+        if (a < b) {
+            return b < c ? b : (a < c ? c : a);
+        }
+        return a < c ? a : (b < c ? c : b);
+    }
+
+    static T pivot(T *arr, size_t len) {
+        size_t mid = len / 2, last = len - 1;
+        if (len < NINTHER_CUTOFF) {
+            return median3(arr[0], arr[mid], arr[last]);
+        }
+        size_t s = len / 8;
+        return median3(median3(arr[0], arr[s], arr[2 * s]),
+                       median3(arr[mid - s], arr[mid], arr[mid + s]),
+                       median3(arr[last - 2 * s], arr[last - s], arr[last]));
+    }
+
+    void sort(T *arr, size_t len, size_t depth, TaskGroup &tg) {
+        while (len > SMALL_CUTOFF) {
+            if (depth == 0) {
+                HeapSort<T>{}.sort(arr, len);
+                return;
+            }
+            depth--;
+            size_t lt, gt;
+            partition3(arr, len, pivot(arr, len), lt, gt);
+            T *l = arr, *r = arr + gt;
+            size_t l_len = lt, r_len = len - gt;
+            if (l_len > r_len) {
+                std::swap(l, r);
+                std::swap(l_len, r_len);
+            }
+            /* smaller side is forked or recursed, larger side loops */
+            if (l_len >= PAR_CUTOFF) {
+                tg.run([this, l, l_len, depth, &tg] { sort(l, l_len, depth, tg); });
+            } else {
+                sort(l, l_len, depth, tg);
+            }
+            arr = r;
+            len = r_len;
+        }
+        small_sort(arr, len);
+    }
+};
+
+/* select and top-k, for when the smallest k or the median is all that is
+ * needed. select is floyd-rivest: a sample around k is selected recursively
+ * and its k-th key partitions the range, so the side holding k shrinks fast.
+ * a range that keeps failing to shrink falls back to a heap, O(n log k) */
+
+/* smallest k + 1 keys into [0, k] through a max-heap of k + 1, arr[k] last */
+template <typename T> void heap_select(T *arr, size_t len, size_t k) {
+    HeapSort<T> h;
+    h.build_heap(arr, k + 1, 0);
+    for (size_t i = k + 1; i < len; i++) {
+        if (arr[i] < arr[0]) {
+            swap(arr[i], arr[0]);
+            h.heapify(arr, k + 1, 0);
+        }
+    }
+    swap(arr[0], arr[k]);
+}
+
+/* reorder so arr[k] is the key a full sort would put there, with no larger
+ * key before it and no smaller one after it. O(n) expected */
+template <typename T> void select(T *arr, size_t len, size_t k) {
+    /* below this the plain median of 3 pivot is cheaper than a sample */
+    const size_t SAMPLE_CUTOFF = 600;
+    if (k >= len) {
+        return;
+    }
+    size_t lo = 0, hi = len, depth = 2 * static_cast<size_t>(std::log2(len)) + 1;
+    while (hi - lo > SIMD_SORT_MAX) {
+        size_t n = hi - lo;
+        if (depth-- == 0) {
+            heap_select(&arr[lo], n, k - lo);
+            return;
+        }
+        if (n > SAMPLE_CUTOFF) {
+            /* sample window sized so the k-th key lands inside it w.h.p. */
+            double i = k - lo, z = std::log(n), s = 0.5 * std::exp(2 * z / 3);
+            double sd = 0.5 * std::sqrt(z * s * (n - s) / n) * (i < n / 2.0 ? -1 : 1);
+            size_t l = std::max<double>(lo, k - i * s / n + sd);
+            size_t r = std::min<double>(hi - 1, k + (n - i) * s / n + sd);
+            select(&arr[l], r - l + 1, k - l);
+        } else {
+            size_t mid = lo + n / 2;
+            if (arr[mid] < arr[lo]) {
+                swap(arr[mid], arr[lo]);
+            }
+            if (arr[hi - 1] < arr[mid]) {
+                swap(arr[hi - 1], arr[mid]);
+                if (arr[mid] < arr[lo]) {
+                    swap(arr[mid], arr[lo]);
+                }
+            }
+            swap(arr[mid], arr[k]);
+        }
+        size_t lt, gt;
+        partition3(&arr[lo], n, arr[k], lt, gt);
+        if (k < lo + lt) {
+            hi = lo + lt;
+        } else if (k >= lo + gt) {
+            lo += gt;
+        } else {
+            return;
+        }
+    }
+    small_sort(&arr[lo], hi - lo);
+}
+
+/* smallest k keys sorted into [0, k), the rest after them in no order.
+ * a max-heap of the best k so far, each later key either loses to the root
+ * or replaces it. O(n log k) */
+template <typename T> void partial_sort(T *arr, size_t len, size_t k) {
+    k = std::min(k, len);
+    if (k == 0) {
+        return;
+    }
+    HeapSort<T> h;
+    h.build_heap(arr, k, 0);
+    for (size_t i = k; i < len; i++) {
+        if (arr[i] < arr[0]) {
+            swap(arr[i], arr[0]);
+            h.heapify(arr, k, 0);
+        }
+    }
+    h.heap_sort(arr, k);
+}
+
+/* smallest k keys of a stream handed over in batches, O(k) memory */
+template <typename T> class TopK {
+  private:
+    size_t k;
+    /* max-heap once full, plain array while filling */
+    std::vector<T> heap;
+
+  public:
+    explicit TopK(size_t k_) : k(k_) { heap.reserve(k); }
+
+    void push(const T *batch, size_t len) {
+        /* no root to compare against */
+        if (k == 0) {
+            return;
+        }
+        size_t i = 0;
+        for (; i < len and heap.size() < k; i++) {
+            heap.push_back(batch[i]);
+            if (heap.size() == k) {
+                HeapSort<T>{}.build_heap(heap.data(), k, 0);
+            }
+        }
+        for (; i < len; i++) {
+            if (batch[i] < heap[0]) {
+                heap[0] = batch[i];
+                HeapSort<T>{}.heapify(heap.data(), k, 0);
+            }
+        }
+    }
+
+    /* at most k keys, ascending */
+    std::vector<T> result() const {
+        std::vector<T> res = heap;
+        HeapSort<T>{}.sort(res.data(), res.size());
+        return res;
+    }
+
+    size_t size() const { return heap.size(); }
+    void clear() { heap.clear(); }
+};
+
 template <typename T> class CountingSort : public Sort<T> {
   private:
-    /* range of data */
+    /* default range of data */
     const static size_t MAX = 0xffffu;
+    /* keys must lie in [0, max_key] */
+    size_t max_key;
   public:
+    explicit CountingSort(size_t max_key_ = MAX) : max_key(max_key_) {}
+
     void sort(T *arr, size_t len) override {
-        T *cnt = new T[MAX + 1]{0};
+        size_t *cnt = new size_t[max_key + 1]{0};
         for(size_t i = 0; i < len; i++) {
-            cnt[arr[i]]++;
+            cnt[sort_key(arr[i])]++;
         }
-        for(size_t i = 1; i < MAX + 1; i++) {
+        for(size_t i = 1; i < max_key + 1; i++) {
             cnt[i] += cnt[i - 1];
         }
         T *tmp = new T[len];
         /* stable */
-        for(int i = len - 1; i >= 0; i--) {
-            tmp[cnt[arr[i]] - 1] = arr[i];
-            cnt[arr[i]]--;
+        for(size_t i = len; i-- > 0;) {
+            tmp[cnt[sort_key(arr[i])] - 1] = arr[i];
+            cnt[sort_key(arr[i])]--;
         }
         std::memcpy(arr, tmp, len * sizeof(T));
         delete[] cnt;
@@ -113,10 +432,184 @@ template <typename T> class CountingSort : public Sort<T> {
     }
 };
 
+/* counting sort over par chunks: every task histograms its own chunk, the
+ * key range is scanned in par slices to get each task's first slot per key,
+ * then every task scatters its chunk forward into disjoint slots, stable */
+template <typename T> class ParallelCountingSort : public Sort<T> {
+  private:
+    const static size_t MAX = 0xffffu;
+    /* below this many keys per task the serial pass wins */
+    const static size_t PAR_CUTOFF = 1 << 14;
+    size_t max_key;
+    ThreadPool &pool;
+    /* par histograms of max_key + 1 counts, task p at p * (max_key + 1).
+     * turned into scatter offsets in place, reused between calls */
+    std::vector<size_t> cnt;
+    std::vector<T> tmp;
+
+    template <typename F> void parallel_for(size_t par, F f) {
+        if (par == 0) {
+            return;
+        }
+        if (par == 1) {
+            f(0);
+            return;
+        }
+        TaskGroup tg{pool};
+        for (size_t p = 0; p < par; p++) {
+            tg.run([=] { f(p); });
+        }
+        tg.wait();
+    }
+
+  public:
+    explicit ParallelCountingSort(size_t max_key_ = MAX, ThreadPool &pool_ = ThreadPool::global())
+        : max_key(max_key_), pool(pool_) {}
+
+    void sort(T *arr, size_t len) override { sort(arr, len, max_key); }
+
+    /* keys in [0, max] for this call only, the histograms shrink to fit */
+    void sort(T *arr, size_t len, size_t max) {
+        if (len <= 1) {
+            return;
+        }
+        const size_t range = max + 1;
+        size_t par = std::clamp<size_t>(len / PAR_CUTOFF, 1, pool.size());
+        cnt.assign(par * range, 0);
+        if (tmp.size() < len) {
+            tmp.resize(len);
+        }
+        size_t *c = cnt.data();
+        T *out = tmp.data();
+
+        /* bounds and strides go into locals first, every store through c or
+         * out could otherwise alias them and force a reload and a division
+         * per key */
+        parallel_for(par, [=](size_t p) {
+            const size_t begin = len * p / par, end = len * (p + 1) / par;
+            size_t *h = &c[p * range];
+            for (size_t i = begin; i < end; i++) {
+                h[sort_key(arr[i])]++;
+            }
+        });
+
+        /* key k of task p starts after every smaller key and after key k of
+         * tasks before p. slice totals first, then the offsets inside. one
+         * slice starts at 0 and needs no totals */
+        std::vector<size_t> slice_base(par + 1, 0);
+        size_t *base = slice_base.data();
+        parallel_for(par == 1 ? 0 : par, [=](size_t s) {
+            const size_t stride = range, tasks = par;
+            const size_t k_begin = stride * s / tasks, k_end = stride * (s + 1) / tasks;
+            size_t sum = 0;
+            for (size_t k = k_begin; k < k_end; k++) {
+                for (size_t p = 0; p < tasks; p++) {
+                    sum += c[p * stride + k];
+                }
+            }
+            base[s + 1] = sum;
+        });
+        for (size_t s = 0; s < par; s++) {
+            slice_base[s + 1] += slice_base[s];
+        }
+        parallel_for(par, [=](size_t s) {
+            const size_t stride = range, tasks = par;
+            const size_t k_begin = stride * s / tasks, k_end = stride * (s + 1) / tasks;
+            size_t sum = base[s];
+            for (size_t k = k_begin; k < k_end; k++) {
+                for (size_t p = 0; p < tasks; p++) {
+                    size_t n = c[p * stride + k];
+                    c[p * stride + k] = sum;
+                    sum += n;
+                }
+            }
+        });
+
+        parallel_for(par, [=](size_t p) {
+            const size_t begin = len * p / par, end = len * (p + 1) / par;
+            size_t *off = &c[p * range];
+            for (size_t i = begin; i < end; i++) {
+                out[off[sort_key(arr[i])]++] = arr[i];
+            }
+        });
+        parallel_for(par, [=](size_t p) {
+            std::copy(out + len * p / par, out + len * (p + 1) / par, arr + len * p / par);
+        });
+    }
+};
+
+/* lsd radix sort for full-width unsigned keys, BITS per digit */
+template <typename T, unsigned BITS = 8> class RadixSort : public Sort<T> {
+    typedef decltype(sort_key(std::declval<T>())) K;
+    static_assert(std::is_integral_v<K> and std::is_unsigned_v<K>,
+                  "radix sort needs unsigned integral keys");
+    static_assert(BITS > 0 and BITS <= 16, "digit too wide");
+
+  private:
+    const static size_t RADIX = size_t{1} << BITS;
+    const static size_t MASK = RADIX - 1;
+    const static unsigned PASSES = (sizeof(K) * CHAR_BIT + BITS - 1) / BITS;
+    /* reused between calls, only grows */
+    std::vector<T> scratch;
+    std::vector<size_t> cnt;
+
+  public:
+    RadixSort() : cnt(PASSES * RADIX) {}
+
+    void sort(T *arr, size_t len) override { sort(arr, len, std::numeric_limits<K>::max()); }
+
+    /* keys in [0, max] for this call only, digits above max are neither
+     * counted nor moved. a digit every key shares makes every histogram
+     * update hit the same counter, a chain through memory that costs more
+     * than the rest of the pass */
+    void sort(T *arr, size_t len, K max) {
+        if (len <= SIMD_SORT_MAX) {
+            /* histograms would cost more than the keys themselves */
+            small_sort(arr, len);
+            return;
+        }
+        if (scratch.size() < len) {
+            scratch.resize(len);
+        }
+        const unsigned passes = std::max<unsigned>(1, (std::bit_width(max) + BITS - 1) / BITS);
+        /* all histograms in one read pass */
+        std::fill(cnt.begin(), cnt.begin() + passes * RADIX, 0);
+        for (size_t i = 0; i < len; i++) {
+            K key = sort_key(arr[i]);
+            for (unsigned p = 0; p < passes; p++) {
+                cnt[p * RADIX + ((key >> (p * BITS)) & MASK)]++;
+            }
+        }
+        T *src = arr, *dst = scratch.data();
+        for (unsigned p = 0; p < passes; p++) {
+            size_t *c = &cnt[p * RADIX];
+            /* every key shares this digit, nothing to move */
+            if (c[(sort_key(src[0]) >> (p * BITS)) & MASK] == len) {
+                continue;
+            }
+            size_t sum = 0;
+            for (size_t d = 0; d < RADIX; d++) {
+                size_t n = c[d];
+                c[d] = sum;
+                sum += n;
+            }
+            /* stable */
+            for (size_t i = 0; i < len; i++) {
+                dst[c[(sort_key(src[i]) >> (p * BITS)) & MASK]++] = src[i];
+            }
+            std::swap(src, dst);
+        }
+        if (src != arr) {
+            std::memcpy(arr, src, len * sizeof(T));
+        }
+    }
+};
+
 template <typename T> class MergeSort : public Sort<T> {
   public:
     void sort(T *arr, size_t len) override {
-        if(len <= 1) {
+        if(len <= SIMD_SORT_MAX) {
+            small_sort(arr, len);
             return;
         }
         size_t mid = len / 2;
@@ -146,34 +639,696 @@ template <typename T> class MergeSort : public Sort<T> {
             r++;
             idx++;
         }
-        std::memcpy(arr, tmp, len * sizeof(T));
+        std::copy(tmp, tmp + len, arr);
         delete[] tmp;
     }
 };
 
-int main() {
+/* bottom-up, one ping-pong buffer, top levels split by merge path */
+template <typename T> class BottomUpMergeSort : public Sort<T> {
+  private:
+    /* leaf block is sorted by one network */
+    const static size_t LEAF = SIMD_SORT_MAX;
+    const static size_t PAR_CUTOFF = 1 << 14;
+    ThreadPool &pool;
+    /* reused between calls, only grows */
+    std::vector<T> buf;
+
+  public:
+    explicit BottomUpMergeSort(ThreadPool &pool_ = ThreadPool::global()) : pool(pool_) {}
+
+    void release() override { std::vector<T>().swap(buf); }
+
+    void sort(T *arr, size_t len) override {
+        if (len <= 1) {
+            return;
+        }
+        if (buf.size() < len) {
+            buf.resize(len);
+        }
+        size_t par = len < PAR_CUTOFF ? 1 : pool.size();
+        for_each_block(len, LEAF, par,
+                       [=](size_t i, size_t n) { small_sort(&arr[i], n); });
+
+        T *src = arr, *dst = buf.data();
+        for (size_t width = LEAF; width < len; width *= 2) {
+            size_t pairs = (len + 2 * width - 1) / (2 * width);
+            if (pairs >= par) {
+                /* plenty of independent merges, hand out whole pairs */
+                for_each_block(len, 2 * width, par, [=](size_t i, size_t n) {
+                    size_t la = std::min(width, n);
+                    merge(&src[i], la, &src[i + la], n - la, &dst[i]);
+                });
+            } else {
+                /* few long merges, split each into par equal shares */
+                TaskGroup tg{pool};
+                for (size_t i = 0; i < len; i += 2 * width) {
+                    size_t n = std::min(2 * width, len - i);
+                    size_t la = std::min(width, n);
+                    for (size_t p = 0; p < par; p++) {
+                        tg.run([=] {
+                            merge_share(&src[i], la, &src[i + la], n - la, &dst[i],
+                                        n * p / par, n * (p + 1) / par);
+                        });
+                    }
+                }
+                tg.wait();
+            }
+            std::swap(src, dst);
+        }
+        if (src != arr) {
+            std::copy(src, src + len, arr);
+        }
+    }
+
+    /* stable, equal keys are taken from a first */
+    static void merge(const T *a, size_t la, const T *b, size_t lb, T *out) {
+        if constexpr (std::is_same_v<T, uint32_t>) {
+            /* equal keys are indistinguishable, stability is free */
+            merge_u32(a, la, b, lb, out);
+            return;
+        }
+        size_t i = 0, j = 0;
+        while (i < la and j < lb) {
+            if (b[j] < a[i]) {
+                *out++ = b[j++];
+            } else {
+                *out++ = a[i++];
+            }
+        }
+        while (i < la) {
+            *out++ = a[i++];
+        }
+        while (j < lb) {
+            *out++ = b[j++];
+        }
+    }
+
+    /* how many elements of a precede output position d */
+    static size_t merge_path(const T *a, size_t la, const T *b, size_t lb, size_t d) {
+        size_t lo = d > lb ? d - lb : 0, hi = std::min(d, la);
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (b[d - mid - 1] < a[mid]) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        return lo;
+    }
+
+  private:
+    /* produce out[begin, end) of merge(a, b) */
+    static void merge_share(const T *a, size_t la, const T *b, size_t lb, T *out,
+                            size_t begin, size_t end) {
+        size_t i = merge_path(a, la, b, lb, begin), j = begin - i;
+        size_t i_end = merge_path(a, la, b, lb, end), j_end = end - i_end;
+        merge(&a[i], i_end - i, &b[j], j_end - j, &out[begin]);
+    }
+
+    /* split [0, len) into blocks of `block` and spread them over par tasks */
+    template <typename F> void for_each_block(size_t len, size_t block, size_t par, F f) {
+        size_t blocks = (len + block - 1) / block;
+        auto run = [=](size_t first, size_t last) {
+            for (size_t b = first; b < last; b++) {
+                f(b * block, std::min(block, len - b * block));
+            }
+        };
+        if (par <= 1) {
+            run(0, blocks);
+            return;
+        }
+        TaskGroup tg{pool};
+        for (size_t p = 0; p < par; p++) {
+            tg.run([=] { run(blocks * p / par, blocks * (p + 1) / par); });
+        }
+        tg.wait();
+    }
+};
+
+/* sorts records R by KeyFn(record) with any algorithm of the hierarchy.
+ * INDIRECT sorts (key, index) pairs and then moves every record once along
+ * the cycles of the permutation, IN_PLACE sorts the records themselves and
+ * is what AUTO picks for records no bigger than IN_PLACE_MAX bytes */
+template <typename R, typename KeyFn, template <typename> class Algo = BottomUpMergeSort>
+class RecordSort : public Sort<R> {
+  public:
+    typedef std::decay_t<std::invoke_result_t<KeyFn, const R &>> K;
+    enum class Mode { AUTO, INDIRECT, IN_PLACE };
+
+  private:
+    /* the in-place cast in sort, a ByKey array must be an R array */
+    static_assert(sizeof(keyed::ByKey<R, KeyFn>) == sizeof(R) and
+                  alignof(keyed::ByKey<R, KeyFn>) == alignof(R) and
+                  std::is_standard_layout_v<keyed::ByKey<R, KeyFn>>);
+    /* two key-index pairs, past that log n moves of the record cost more
+     * than one random gather */
+    const static size_t IN_PLACE_MAX = 2 * sizeof(keyed::KeyIndex<K>);
+
+    Algo<keyed::KeyIndex<K>> index_sort;
+    Algo<keyed::ByKey<R, KeyFn>> record_sort;
+    Mode mode;
+    std::vector<keyed::KeyIndex<K>> pairs;
+
+    /* record pairs[i].idx belongs at i. a placed slot gets idx = i */
+    void permute(R *arr, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            if (pairs[i].idx == i) {
+                continue;
+            }
+            R tmp = std::move(arr[i]);
+            size_t j = i;
+            while (pairs[j].idx != i) {
+                size_t k = pairs[j].idx;
+                arr[j] = std::move(arr[k]);
+                pairs[j].idx = j;
+                j = k;
+            }
+            arr[j] = std::move(tmp);
+            pairs[j].idx = j;
+        }
+    }
+
+  public:
+    explicit RecordSort(Mode mode_ = Mode::AUTO) : mode(mode_) {}
+
+    void sort(R *arr, size_t len) override {
+        bool in_place = mode == Mode::IN_PLACE or (mode == Mode::AUTO and sizeof(R) <= IN_PLACE_MAX);
+        if (in_place) {
+            /* sound only by the static_assert above: same size, alignment
+             * and address, so every element of the cast array is a record */
+            record_sort.sort(reinterpret_cast<keyed::ByKey<R, KeyFn> *>(arr), len);
+            return;
+        }
+        pairs.resize(len);
+        for (size_t i = 0; i < len; i++) {
+            pairs[i] = {KeyFn{}(arr[i]), i};
+        }
+        index_sort.sort(pairs.data(), len);
+        permute(arr, len);
+    }
+};
+
+/* profiles the input in one pass plus a small sample and hands it to the
+ * algorithm that measured fastest for that shape. thresholds come from
+ * main --bench and a duplicate sweep with unsigned keys on a one thread
+ * pool. MERGE, COUNTING and INTROSORT run on the pool, with more threads
+ * they win earlier and the cut-overs move down.
+ *
+ * unsigned keys the histogram does not fit go to RADIX from RADIX_MIN_LEN.
+ * uint32 keys on an avx2 host are the exception: they take RADIX only when
+ * the keys seen are narrow enough for radix to beat the avx2 merge kernel,
+ * and MERGE otherwise, at any length */
+template <typename T> class AdaptiveSort : public Sort<T> {
+  public:
+    enum class Path { SMALL, RUNS, COUNTING, RADIX, MERGE, INTROSORT };
+
+    struct Profile {
+        size_t len, runs;
+        /* distinct keys among `sample` evenly spaced ones */
+        size_t distinct, sample;
+        T min, max;
+    };
+
+  private:
+    /* runs longer than a network leaf need fewer merge levels than merge sort */
+    const static size_t MIN_AVG_RUN = SIMD_SORT_MAX;
+    /* 64k-entry histogram paid back once len >= (max + 1) / 8, 2^15 vs 2^12 */
+    const static size_t COUNTING_MAX = 0xffffu;
+    const static size_t COUNTING_DENSITY = 8;
+    /* radix overtakes introsort between 2^9 and 2^12 */
+    const static size_t RADIX_MIN_LEN = 1 << 9;
+    /* radix only runs the digits below max. against the avx2 merge kernel
+     * on 32-bit keys it wins from 2^9 with two digits, from 2^11 with
+     * three, and ties with four. below 2^9 merge beats both radix and
+     * introsort at every width */
+    const static size_t THREE_DIGIT_RADIX_MIN_LEN = 1 << 11;
+    /* with this few distinct keys three-way partitioning needs ~log d levels
+     * and beat radix and merge at 2^12..2^18 */
+    const static size_t FEW_DISTINCT = 8;
+    /* one network sorts the sample */
+    const static size_t SAMPLE = SIMD_SORT_MAX;
+
+    ThreadPool &pool;
+    ParallelQuickSort<T> introsort;
+    BottomUpMergeSort<T> merge_sort;
+    /* made on first use, their buffers are kept for the next call. keys
+     * without a counting path never name ParallelCountingSort */
+    std::unique_ptr<std::conditional_t<std::is_integral_v<T> and std::is_unsigned_v<T>,
+                                       ParallelCountingSort<T>, Sort<T>>>
+        counting;
+    std::unique_ptr<std::conditional_t<std::is_integral_v<T> and std::is_unsigned_v<T>, RadixSort<T>, Sort<T>>>
+        radix;
+    /* natural merge state, reused between calls */
+    std::vector<T> buf;
+    std::vector<size_t> bounds, next_bounds;
+    Profile last;
+
+    /* non-descending runs, descending ones count too and are reversed when
+     * bounds are collected. a run of equal keys goes whichever way the first
+     * unequal pair goes, or reverse input with duplicates splits into many
+     * short runs. stops counting once past limit */
+    static size_t count_runs(T *arr, size_t len, size_t limit, std::vector<size_t> *bounds) {
+        size_t runs = 0, i = 0;
+        while (i < len and runs <= limit) {
+            size_t j = i + 1;
+            while (j < len and not(arr[j] < arr[j - 1]) and not(arr[j - 1] < arr[j])) {
+                j++;
+            }
+            if (j < len and arr[j] < arr[j - 1]) {
+                while (j < len and not(arr[j - 1] < arr[j])) {
+                    j++;
+                }
+                for (size_t l = i, r = j - 1; bounds and l < r; l++, r--) {
+                    swap(arr[l], arr[r]);
+                }
+            } else {
+                while (j < len and not(arr[j] < arr[j - 1])) {
+                    j++;
+                }
+            }
+            if (bounds) {
+                bounds->push_back(i);
+            }
+            runs++;
+            i = j;
+        }
+        return runs;
+    }
+
+    void merge_runs(T *arr, size_t len) {
+        if (buf.size() < len) {
+            buf.resize(len);
+        }
+        bounds.clear();
+        count_runs(arr, len, len, &bounds);
+        bounds.push_back(len);
+        T *src = arr, *dst = buf.data();
+        while (bounds.size() > 2) {
+            next_bounds.clear();
+            size_t r = 0;
+            for (; r + 2 < bounds.size(); r += 2) {
+                size_t a = bounds[r], b = bounds[r + 1], e = bounds[r + 2];
+                BottomUpMergeSort<T>::merge(&src[a], b - a, &src[b], e - b, &dst[a]);
+                next_bounds.push_back(a);
+            }
+            if (r + 1 < bounds.size()) {
+                /* odd run out, carried over as is */
+                std::copy(&src[bounds[r]], &src[len], &dst[bounds[r]]);
+                next_bounds.push_back(bounds[r]);
+            }
+            next_bounds.push_back(len);
+            bounds.swap(next_bounds);
+            std::swap(src, dst);
+        }
+        if (src != arr) {
+            std::copy(src, src + len, arr);
+        }
+    }
+
+  public:
+    explicit AdaptiveSort(ThreadPool &pool_ = ThreadPool::global())
+        : pool(pool_), introsort(pool_), merge_sort(pool_) {}
+
+    Path choose(T *arr, size_t len) {
+        last = Profile{len, 0, 0, 0, T{}, T{}};
+        if (len <= SIMD_SORT_MAX) {
+            return Path::SMALL;
+        }
+        last.runs = count_runs(arr, len, len / MIN_AVG_RUN, nullptr);
+        if (last.runs <= len / MIN_AVG_RUN) {
+            return Path::RUNS;
+        }
+        last.sample = SAMPLE;
+        std::vector<T> sample;
+        for (size_t i = 0; i < last.sample; i++) {
+            sample.push_back(arr[i * len / last.sample]);
+        }
+        small_sort(sample.data(), last.sample);
+        last.distinct = 1;
+        for (size_t i = 1; i < last.sample; i++) {
+            last.distinct += sample[i - 1] < sample[i];
+        }
+        if (last.distinct <= FEW_DISTINCT) {
+            return Path::INTROSORT;
+        }
+        if constexpr (std::is_integral_v<T> and std::is_unsigned_v<T>) {
+            /* minmax_element branches on every pair of keys */
+            if constexpr (std::is_same_v<T, uint32_t>) {
+                std::tie(last.min, last.max) = minmax_u32(arr, len);
+            } else {
+                T min = arr[0], max = arr[0];
+                for (size_t i = 1; i < len; i++) {
+                    min = std::min(min, arr[i]);
+                    max = std::max(max, arr[i]);
+                }
+                last.min = min;
+                last.max = max;
+            }
+            if (last.max <= COUNTING_MAX and len >= (last.max + size_t{1}) / COUNTING_DENSITY) {
+                return Path::COUNTING;
+            }
+            if (std::is_same_v<T, uint32_t> and simd_level() == SimdLevel::AVX2) {
+                bool radix_wins = len >= RADIX_MIN_LEN and
+                                  (last.max <= 0xffffu or
+                                   (last.max <= 0xffffffu and len >= THREE_DIGIT_RADIX_MIN_LEN));
+                return radix_wins ? Path::RADIX : Path::MERGE;
+            }
+            if (len >= RADIX_MIN_LEN) {
+                return Path::RADIX;
+            }
+        }
+        return Path::INTROSORT;
+    }
+
+    void sort(T *arr, size_t len) override {
+        switch (choose(arr, len)) {
+        case Path::SMALL:
+            small_sort(arr, len);
+            break;
+        case Path::RUNS:
+            merge_runs(arr, len);
+            break;
+        case Path::COUNTING:
+            if constexpr (std::is_integral_v<T> and std::is_unsigned_v<T>) {
+                if (not counting) {
+                    counting.reset(new ParallelCountingSort<T>{COUNTING_MAX, pool});
+                }
+                /* histogram only as wide as the keys seen */
+                counting->sort(arr, len, last.max);
+            }
+            break;
+        case Path::RADIX:
+            if constexpr (std::is_integral_v<T> and std::is_unsigned_v<T>) {
+                if (not radix) {
+                    radix.reset(new RadixSort<T>);
+                }
+                /* only the digits of the keys seen */
+                radix->sort(arr, len, last.max);
+            }
+            break;
+        case Path::MERGE:
+            merge_sort.sort(arr, len);
+            break;
+        case Path::INTROSORT:
+            introsort.sort(arr, len);
+            break;
+        }
+    }
+
+    const Profile &last_profile() const { return last; }
+};
+
+/* networks and merge kernels against std::sort, around every block size */
+void kernel_check(SimdLevel level) {
+    using namespace std;
+
+    simd_cap = level;
+    mt19937 eng{1};
+    for (size_t len = 0; len <= SIMD_SORT_MAX; len++) {
+        for (unsigned range : {4u, 0xffffffffu}) {
+            vector<uint32_t> v(len);
+            for (auto &&x : v) {
+                x = eng() % range;
+            }
+            auto want = v;
+            std::sort(want.begin(), want.end());
+            bitonic_sort_u32(v.data(), len);
+            assert(v == want);
+        }
+    }
+    for (size_t n : {16, 32, 64}) {
+        for (int rep = 0; rep < 100; rep++) {
+            vector<uint32_t> v(n);
+            for (auto &&x : v) {
+                x = eng() % (rep % 2 ? 8 : 1000);
+            }
+            auto want = v;
+            std::sort(v.begin(), v.begin() + n / 2);
+            std::sort(v.begin() + n / 2, v.end());
+            std::sort(want.begin(), want.end());
+            bitonic_merge_u32(v.data(), n);
+            assert(v == want);
+        }
+    }
+    for (size_t la : {0, 1, 7, 8, 9, 16, 100}) {
+        for (size_t lb : {0, 3, 8, 15, 64, 257}) {
+            vector<uint32_t> a(la), b(lb), out(la + lb);
+            for (auto &&x : a) {
+                x = eng() % 50;
+            }
+            for (auto &&x : b) {
+                x = eng() % 50;
+            }
+            std::sort(a.begin(), a.end());
+            std::sort(b.begin(), b.end());
+            auto want = a;
+            want.insert(want.end(), b.begin(), b.end());
+            std::sort(want.begin(), want.end());
+            merge_u32(a.data(), la, b.data(), lb, out.data());
+            assert(out == want);
+        }
+    }
+    for (size_t len : {1, 7, 8, 9, 100}) {
+        vector<uint32_t> v(len);
+        for (auto &&x : v) {
+            x = eng();
+        }
+        auto [mn, mx] = minmax_element(v.begin(), v.end());
+        assert(minmax_u32(v.data(), len) == make_pair(*mn, *mx));
+    }
+    simd_cap = SimdLevel::AVX2;
+}
+
+/* select, partial_sort and TopK against a full sort, k at both ends and
+ * past len, lengths across the network and sample cutoffs */
+void select_check() {
+    using namespace std;
+
+    mt19937 eng{3};
+    for (size_t len : {0, 1, 2, 63, 64, 65, 599, 601, 5000}) {
+        for (unsigned range : {3u, 0xffffffffu}) {
+            vector<uint32_t> in(len);
+            for (auto &&x : in) {
+                x = eng() % range;
+            }
+            auto want = in;
+            std::sort(want.begin(), want.end());
+            for (size_t k : {size_t{0}, size_t{1}, len / 2, len - 1, len, len + 1}) {
+                if (k > len + 1) {
+                    /* len - 1 wrapped */
+                    continue;
+                }
+                if (k < len) {
+                    auto v = in;
+                    select(v.data(), len, k);
+                    assert(v[k] == want[k]);
+                    for (size_t i = 0; i < len; i++) {
+                        assert(i > k or not(v[k] < v[i]));
+                        assert(i < k or not(v[i] < v[k]));
+                    }
+                }
+                auto v = in;
+                partial_sort(v.data(), len, k);
+                size_t n = min(k, len);
+                assert(equal(v.begin(), v.begin() + n, want.begin()));
+                sort(v.begin(), v.end());
+                assert(v == want);
+
+                /* the stream in uneven batches */
+                TopK<uint32_t> top{k};
+                for (size_t i = 0; i < len; i += i % 7 + 1) {
+                    top.push(&in[i], min(len, i + i % 7 + 1) - i);
+                }
+                auto res = top.result();
+                assert(res.size() == n and equal(res.begin(), res.end(), want.begin()));
+            }
+        }
+    }
+}
+
+/* a record small enough for AUTO to sort in place, and one that is not.
+ * out of the global namespace for the same reason as keyed:: */
+namespace check {
+
+template <size_t PAD> struct Record {
+    uint32_t key, id;
+    char pad[PAD];
+
+    struct Key {
+        uint32_t operator()(const Record &r) const { return r.key; }
+    };
+};
+
+} // namespace check
+
+/* RecordSort in every mode against std::stable_sort. the indirect path is
+ * stable under any algorithm, in place only under a stable one */
+template <typename R, template <typename> class Algo> void record_check(bool stable) {
+    using namespace std;
+    typedef RecordSort<R, typename R::Key, Algo> RS;
+
+    mt19937 eng{2};
+    for (size_t len : {0, 1, 2, 17, 1000}) {
+        for (auto mode : {RS::Mode::AUTO, RS::Mode::INDIRECT, RS::Mode::IN_PLACE}) {
+            vector<R> v(len);
+            for (uint32_t i = 0; i < len; i++) {
+                v[i] = {static_cast<uint32_t>(eng() % 64), i, {}};
+            }
+            auto want = v;
+            std::stable_sort(want.begin(), want.end(), [](const R &a, const R &b) { return a.key < b.key; });
+            RS rs{mode};
+            rs.sort(v.data(), len);
+            bool exact = stable or mode == RS::Mode::INDIRECT or
+                         (mode == RS::Mode::AUTO and sizeof(R) > 2 * sizeof(keyed::KeyIndex<uint32_t>));
+            for (size_t i = 0; i < len; i++) {
+                assert(v[i].key == want[i].key);
+                assert(not exact or v[i].id == want[i].id);
+            }
+        }
+    }
+}
+
+/* exercises what no other mode reaches, aborts on the first mismatch */
+int check_main() {
+    using namespace std;
+
+    /* every level this cpu runs, not only the one it dispatches to */
+    for (auto level : {SimdLevel::SCALAR, SimdLevel::SSE4, SimdLevel::AVX2}) {
+        if (level <= simd_support()) {
+            kernel_check(level);
+        }
+    }
+    cout << "kernel check passed\n";
+    record_check<check::Record<0>, BottomUpMergeSort>(true);
+    record_check<check::Record<56>, BottomUpMergeSort>(true);
+    record_check<check::Record<0>, QuickSort>(false);
+    record_check<check::Record<56>, QuickSort>(false);
+    record_check<check::Record<0>, RadixSort>(true);
+    cout << "record check passed\n";
+    select_check();
+    cout << "select check passed\n";
+    return 0;
+}
+
+/* every algorithm over the size x distribution matrix, into bench.{csv,json} */
+int bench_main(size_t reps) {
+    using namespace std;
+
+    Benchmark<unsigned> bench{2, reps};
+    bench.add("quick_sort", new QuickSort<unsigned>, new QuickSort<Counted<unsigned>>);
+    bench.add("heap_sort", new HeapSort<unsigned>, new HeapSort<Counted<unsigned>>);
+    bench.add("dary_heap_sort", new DaryHeapSort<unsigned>, new DaryHeapSort<Counted<unsigned>>);
+    bench.add("merge_sort", new MergeSort<unsigned>, new MergeSort<Counted<unsigned>>);
+    bench.add("counting_sort", new CountingSort<unsigned>);
+    bench.add("parallel_counting_sort", new ParallelCountingSort<unsigned>);
+    bench.add("radix_sort", new RadixSort<unsigned>);
+    bench.add("parallel_quick_sort", new ParallelQuickSort<unsigned>,
+              new ParallelQuickSort<Counted<unsigned>>);
+    bench.add("bottom_up_merge_sort", new BottomUpMergeSort<unsigned>,
+              new BottomUpMergeSort<Counted<unsigned>>);
+    bench.add("adaptive_sort", new AdaptiveSort<unsigned>, new AdaptiveSort<Counted<unsigned>>);
+    vector<size_t> lens{1 << 3, 1 << 6, 1 << 9, 1 << 12, 1 << 15, 1 << 18};
+    vector<Dist> dists{Dist::UNIFORM, Dist::SORTED, Dist::REVERSE,
+                       Dist::FEW_UNIQUE, Dist::ZIPF, Dist::ORGAN_PIPE};
+    auto res = bench.run(lens, dists);
+    ofstream csv{"../output/bench.csv"}, json{"../output/bench.json"};
+    Benchmark<unsigned>::write_csv(csv, res);
+    Benchmark<unsigned>::write_json(json, res);
+    return 0;
+}
+
+/* pass --binary to read input.bin and write mapped result_N.bin files,
+ * --perf to also record hardware counters into perf.txt next to time.txt,
+ * --external <in.bin> <out.bin> [budget MiB] to sort one file out of core,
+ * --bench [reps] for the benchmark matrix or --check for the self checks */
+int main(int argc, char *argv[]) {
     using namespace std;
 
-    string input = "../input/input.txt";
+    if (argc > 1 and string{argv[1]} == "--check") {
+        return check_main();
+    }
+
+    if (argc > 1 and string{argv[1]} == "--bench") {
+        return bench_main(argc > 2 ? stoull(argv[2]) : 10);
+    }
+
+    if (argc > 3 and string{argv[1]} == "--external") {
+        size_t budget = (argc > 4 ? stoull(argv[4]) : 256) << 20;
+        BottomUpMergeSort<unsigned> run_sort;
+        ExternalSort<unsigned> ext{run_sort, budget};
+        typedef chrono::high_resolution_clock clk;
+        auto start = clk::now();
+        if (not ext.sort(argv[2], argv[3])) {
+            cerr << "external sort failed\n";
+            return 1;
+        }
+        auto end = clk::now();
+        cout << chrono::duration_cast<chrono::nanoseconds>(end - start).count() << " (ns)\n";
+        return 0;
+    }
+
+    bool binary = false, perf = false;
+    for (int i = 1; i < argc; i++) {
+        binary = binary or string{argv[i]} == "--binary";
+        perf = perf or string{argv[i]} == "--perf";
+    }
+    string input = binary ? "../input/input.bin" : "../input/input.txt";
+    string ext = binary ? ".bin" : ".txt";
     vector<size_t> sort_lens{1 << 3, 1 << 6, 1 << 9, 1 << 12, 1 << 15, 1 << 18};
     vector<pair<string, Sort<unsigned> *>> sort_algos{
         {"../output/quick_sort", new QuickSort<unsigned>},
         {"../output/heap_sort", new HeapSort<unsigned>},
+        {"../output/dary_heap_sort", new DaryHeapSort<unsigned>},
         {"../output/merge_sort", new MergeSort<unsigned>},
-        {"../output/counting_sort", new CountingSort<unsigned>}
+        {"../output/counting_sort", new CountingSort<unsigned>},
+        {"../output/parallel_counting_sort", new ParallelCountingSort<unsigned>},
+        {"../output/radix_sort", new RadixSort<unsigned>},
+        {"../output/parallel_quick_sort", new ParallelQuickSort<unsigned>},
+        {"../output/bottom_up_merge_sort", new BottomUpMergeSort<unsigned>},
+        {"../output/adaptive_sort", new AdaptiveSort<unsigned>}
     };
     auto in = SortData<unsigned>{input, SortData<unsigned>::MAX_LEN};
-    in.read();
+    if (not (binary ? in.read_binary() : in.read())) {
+        cerr << "cannot read " << input << '\n';
+        return 1;
+    }
     for (auto &&algo : sort_algos) {
         ofstream time_file{algo.first + "/time.txt", ofstream::out};
+        /* without usable counters this quietly stays wall-clock only */
+        unique_ptr<PerfSort<unsigned>> perf_sort;
+        ofstream perf_file;
+        if (perf) {
+            perf_sort.reset(new PerfSort<unsigned>{*algo.second});
+        }
+        if (perf_sort and perf_sort->available()) {
+            perf_file.open(algo.first + "/perf.txt", ofstream::out);
+            PerfCounters::write_header(perf_file);
+        }
         for (auto len : sort_lens) {
             auto out = SortData<unsigned>{
-                algo.first + "/result_" + to_string(static_cast<unsigned>(log2(len))) + ".txt",
+                algo.first + "/result_" + to_string(static_cast<unsigned>(log2(len))) + ext,
                 len};
             memcpy(out.get().first, in.get().first, len * sizeof(unsigned));
-            auto t = algo.second->measure_time_sort(out.get().first, len);
-            time_file << t << '\n';
-            out.write();
+            /* sorted in place inside the mapping, nothing left to format */
+            if (binary and not out.create_binary()) {
+                cerr << "cannot map " << algo.first << '\n';
+                return 1;
+            }
+            if (perf_file.is_open()) {
+                auto t = perf_sort->measure_time_sort(out.get().first, len);
+                time_file << t << '\n';
+                PerfCounters::write(perf_file, perf_sort->last_sample());
+            } else {
+                auto t = algo.second->measure_time_sort(out.get().first, len);
+                time_file << t << '\n';
+            }
+            if (binary) {
+                out.sync();
+            } else {
+                out.write();
+            }
         }
         time_file << "(ns)\n";
         time_file.close();
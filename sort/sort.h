@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <type_traits>
+
+/* common interface for time measurement*/
+template <typename T> class Sort {
+  public:
+    virtual ~Sort() {};
+    virtual void sort(T *arr, size_t len) = 0;
+    /* drop scratch kept for the next call */
+    virtual void release() {}
+    size_t measure_time_sort(T *arr, size_t len) {
+        typedef std::chrono::high_resolution_clock clk;
+        auto start = clk::now();
+        sort(arr, len);
+        auto end = clk::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    }
+};
+
+/* the key a distribution sort (counting, radix) looks at. comparison sorts
+ * only need operator<, which the wrappers below define on the same key */
+template <typename T>
+    requires std::is_arithmetic_v<T>
+T sort_key(const T &x) {
+    return x;
+}
+
+/* the record wrappers live apart from the global swap template in sort.cpp,
+ * with both in view an unqualified swap in std algorithms is ambiguous */
+namespace keyed {
+
+/* (key, index) pair for indirect sorting, ties broken by index so even an
+ * unstable algorithm yields the stable permutation */
+template <typename K> struct KeyIndex {
+    K key;
+    size_t idx;
+
+    bool operator<(const KeyIndex &rhs) const {
+        return key < rhs.key or (not(rhs.key < key) and idx < rhs.idx);
+    }
+    bool operator>(const KeyIndex &rhs) const { return rhs < *this; }
+};
+
+template <typename K> K sort_key(const KeyIndex<K> &x) { return x.key; }
+
+/* a record viewed through its key. RecordSort sorts an array of R in place
+ * by casting it to an array of ByKey, which relies on ByKey being standard
+ * layout with rec its only member, so both have the same size, alignment and
+ * address. RecordSort static_asserts this, keep ByKey free of other members
+ * and of virtual functions */
+template <typename R, typename KeyFn> struct ByKey {
+    R rec;
+
+    bool operator<(const ByKey &rhs) const { return KeyFn{}(rec) < KeyFn{}(rhs.rec); }
+    bool operator>(const ByKey &rhs) const { return rhs < *this; }
+};
+
+template <typename R, typename KeyFn> auto sort_key(const ByKey<R, KeyFn> &x) {
+    return KeyFn{}(x.rec);
+}
+
+} // namespace keyed
@@ -1,8 +1,47 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <ostream>
 #include <random>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* binary file layout: header, then count elements of T in host byte order */
+struct SortDataHeader {
+    char magic[4];
+    /* reads back as ORDER_MARK only on a host with the writer's endianness */
+    uint32_t byte_order;
+    uint32_t type_tag;
+    uint32_t reserved;
+    uint64_t count;
+
+    const static uint32_t ORDER_MARK = 0x01020304u;
+
+    /* element size, signedness and float-ness of T */
+    template <typename T> static uint32_t tag_of() {
+        return sizeof(T) | std::is_signed_v<T> << 8 | std::is_floating_point_v<T> << 9;
+    }
+
+    template <typename T> static SortDataHeader make(uint64_t count) {
+        return {{'S', 'R', 'T', 'D'}, ORDER_MARK, tag_of<T>(), 0, count};
+    }
+
+    template <typename T> bool valid() const {
+        return std::memcmp(magic, "SRTD", 4) == 0 and byte_order == ORDER_MARK and
+               type_tag == tag_of<T>();
+    }
+};
 
 /* sort data io, alse generate random data */
 template <typename T> class SortData {
@@ -11,41 +50,163 @@ template <typename T> class SortData {
 
   private:
     const static size_t SEED = 1;
+    /* text output is formatted into this much memory before each write */
+    const static size_t WRITE_BUF = 1 << 20;
     std::string file_name;
-    std::unique_ptr<T> uptr;
+    std::unique_ptr<T[]> uptr;
     size_t data_len;
+    /* set when the data lives in a shared file mapping instead of uptr */
+    void *map_base = nullptr;
+    size_t map_size = 0;
 
   public:
     SortData(std::string file_name_, size_t data_len_)
         : file_name(file_name_), data_len{data_len_} {
         uptr.reset(new T[data_len_]);
     }
+    SortData(const SortData &) = delete;
+    ~SortData() { unmap(); }
 
-    std::pair<T *, size_t> get() { return {uptr.get(), data_len}; }
+    std::pair<T *, size_t> get() { return {data(), data_len}; }
 
     void gen() {
         std::default_random_engine eng{SEED};
         std::uniform_int_distribution<unsigned> dist{0, 0xffffu};
         for (size_t i = 0; i < data_len; i++) {
-            uptr.get()[i] = dist(eng);
+            data()[i] = dist(eng);
         }
     }
 
-    void read() {
-        std::ifstream f{file_name, std::ifstream::in};
-        for(size_t i = 0; i < data_len; i++) {
-            f >> uptr.get()[i];
+    /* whole file in one read, parsed with from_chars. false on a missing
+     * file, a token that is not a T or fewer than data_len numbers, the data
+     * is then not to be used */
+    bool read() {
+        std::ifstream f{file_name, std::ifstream::in | std::ifstream::binary};
+        if (not f) {
+            return false;
         }
-        f.close();
+        std::string buf{std::istreambuf_iterator<char>{f}, {}};
+        const char *p = buf.data(), *end = p + buf.size();
+        for (size_t i = 0; i < data_len; i++) {
+            while (p < end and (*p == ' ' or *p == '\n' or *p == '\r' or *p == '\t')) {
+                p++;
+            }
+            auto res = std::from_chars(p, end, data()[i]);
+            if (res.ec != std::errc{}) {
+                return false;
+            }
+            p = res.ptr;
+        }
+        return true;
     }
 
+    /* formatted with to_chars into a large buffer, one write per buffer */
     void write() {
-        std::ofstream f{file_name, std::ofstream::out};
+        std::ofstream f{file_name, std::ofstream::out | std::ofstream::binary};
+        std::unique_ptr<char[]> buf{new char[WRITE_BUF]};
+        size_t used = 0;
         for (size_t i = 0; i < data_len; i++) {
-            f << uptr.get()[i] << '\n';
+            if (WRITE_BUF - used < 64) {
+                f.write(buf.get(), used);
+                used = 0;
+            }
+            auto res = std::to_chars(&buf[used], &buf[WRITE_BUF], data()[i]);
+            used = res.ptr - buf.get();
+            buf[used++] = '\n';
         }
+        f.write(buf.get(), used);
+        f.close();
+    }
+
+    /* false on a missing file, a foreign header or fewer than data_len
+     * elements, the data is then not to be used */
+    bool read_binary() {
+        std::ifstream f{file_name, std::ifstream::in | std::ifstream::binary};
+        SortDataHeader h;
+        f.read(reinterpret_cast<char *>(&h), sizeof(h));
+        if (f.gcount() != sizeof(h) or not h.valid<T>() or h.count < data_len) {
+            return false;
+        }
+        auto bytes = static_cast<std::streamsize>(data_len * sizeof(T));
+        f.read(reinterpret_cast<char *>(data()), bytes);
+        return f.gcount() == bytes;
+    }
+
+    void write_binary() {
+        std::ofstream f{file_name, std::ofstream::out | std::ofstream::binary};
+        auto h = SortDataHeader::make<T>(data_len);
+        f.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        f.write(reinterpret_cast<const char *>(data()), data_len * sizeof(T));
         f.close();
     }
+
+    /* map an existing binary file read-write, get() then points into the file
+     * and sorting it sorts the file. data_len becomes the element count */
+    bool map_binary() {
+        int fd = open(file_name.c_str(), O_RDWR);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        bool ok = fstat(fd, &st) == 0 and static_cast<size_t>(st.st_size) >= sizeof(SortDataHeader) and
+                  map_fd(fd, st.st_size);
+        close(fd);
+        if (not ok) {
+            return false;
+        }
+        auto h = header();
+        if (not h->template valid<T>() or sizeof(SortDataHeader) + h->count * sizeof(T) > map_size) {
+            unmap();
+            return false;
+        }
+        data_len = h->count;
+        uptr.reset();
+        return true;
+    }
+
+    /* create (or truncate) a binary file of data_len elements and map it, the
+     * current contents are copied in */
+    bool create_binary() {
+        int fd = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        size_t size = sizeof(SortDataHeader) + data_len * sizeof(T);
+        bool ok = ftruncate(fd, size) == 0 and map_fd(fd, size);
+        close(fd);
+        if (not ok) {
+            return false;
+        }
+        *header() = SortDataHeader::make<T>(data_len);
+        std::memcpy(mapped(), uptr.get(), data_len * sizeof(T));
+        uptr.reset();
+        return true;
+    }
+
+    /* flush a mapped file to disk */
+    bool sync() { return map_base == nullptr or msync(map_base, map_size, MS_SYNC) == 0; }
+
+  private:
+    T *data() { return map_base ? mapped() : uptr.get(); }
+    SortDataHeader *header() { return static_cast<SortDataHeader *>(map_base); }
+    T *mapped() { return reinterpret_cast<T *>(header() + 1); }
+
+    bool map_fd(int fd, size_t size) {
+        void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            return false;
+        }
+        map_base = p;
+        map_size = size;
+        return true;
+    }
+
+    void unmap() {
+        if (map_base) {
+            munmap(map_base, map_size);
+            map_base = nullptr;
+        }
+    }
 };
 
 template <typename T>
@@ -55,4 +216,4 @@ std::ostream &operator<<(std::ostream &os, SortData<T> &data) {
         os << ptr[i] << '\n';
     }
     return os;
-}
\ No newline at end of file
+}